@@ -0,0 +1,609 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+/**
+ * \file check.cpp
+ *
+ * \brief Check the native implementations against TA-lib.
+ *
+ * Every function of the native tables, in double and in float, is computed
+ * by TA with its native implementation and again by TA-lib with
+ * setNativeEnabled(false), and the outputs are compared.  The functions run
+ * with their default options and with each option changed in turn, with
+ * and without unstable periods, in the default and the Metastock
+ * compatibility modes, and on candles that start at 0 or later.  The
+ * candles are a random walk on a coarse grid with flat stretches, so that
+ * windows have ties of highs, lows and closes.  The series functions that
+ * compute several outputs or periods at once, such as emaRibbon(),
+ * hilbert() or correlations(), are checked against TA-lib output by
+ * output.  CandleScan is checked against TA of each pattern with the
+ * default and other candle settings.
+ * The streaming states are fed the candles bar by bar and checked at every
+ * bar against the series functions they shortcut.
+ *
+ * One line is printed for each mismatch; the program returns 1 if there
+ * is any.
+ */
+
+#include <iostream>
+#include <sstream>
+#include "ta++.h"
+
+using namespace tapp;
+
+namespace {
+
+/// Tolerance of the real outputs, relative to the largest reference value.
+static const double DOUBLE_TOLERANCE = 1e-8;
+static const double FLOAT_TOLERANCE = 1e-3;
+
+/// A checked combination of options.
+struct Variant {
+    std::string label;
+    TA::Options options;
+};
+
+/// A checked environment of TA-lib.
+struct Config {
+    const char *label;
+    TA_Compatibility compatibility;
+    unsigned unstable;
+    TA_Integer first;
+};
+
+unsigned checks = 0, failures = 0;
+
+/// Random walk on a grid of 0.25, the same on all platforms.
+Candles makeCandles (unsigned n, TA_Integer first)
+{
+    unsigned state = 12345;
+    Candles candles;
+    double price = 50;
+    Candle last(price, price, price, price, 1000, 0, str2time("2000-01-03"));
+    for (unsigned i = 0; i < n; ++i) {
+        state = state * 1103515245 + 12345;
+        unsigned r = state >> 8;
+        Time time = str2time("2000-01-03") + boost::gregorian::days(i);
+        if (i > 0 && r % 5 == 0) {
+            // A flat stretch repeats the previous candle.
+            last.time = time;
+            candles.push_back(last);
+            continue;
+        }
+        double open = price;
+        price = std::max(5.0, price + (int(r % 9) - 4) * 0.25);
+        double high = std::max(open, price) + (r / 9 % 3) * 0.25;
+        double low = std::min(open, price) - (r / 27 % 3) * 0.25;
+        last = Candle(open, high, low, price, 1000 + (r / 81 % 20) * 100, 0, time);
+        candles.push_back(last);
+    }
+    candles.setFirst(first);
+    return candles;
+}
+
+const TA_FuncInfo *funcInfo (const std::string &name)
+{
+    const TA_FuncHandle *handle;
+    const TA_FuncInfo *info;
+    if (TA_GetFuncHandle(name.c_str(), &handle) != TA_SUCCESS) panic();
+    if (TA_GetFuncInfo(handle, &info) != TA_SUCCESS) panic();
+    return info;
+}
+
+bool isPriceInput (const TA_FuncInfo *info, unsigned idx)
+{
+    const TA_InputParameterInfo *input;
+    if (TA_GetInputParameterInfo(info->handle, idx, &input) != TA_SUCCESS) panic();
+    return input->type == TA_Input_Price;
+}
+
+/// The default options, and each option changed in turn.
+/**
+ * Integer ranges take their minimum and the default plus 3, integer lists
+ * such as the moving average types take all their values, and real ranges
+ * take half and twice the default, or 0.5 if the default is 0, within the
+ * range.
+ */
+std::vector<Variant> variants (const TA_FuncInfo *info)
+{
+    std::vector<Variant> r(1);
+    r[0].label = "default";
+    for (unsigned i = 0; i < info->nbOptInput; ++i) {
+        const TA_OptInputParameterInfo *opt;
+        if (TA_GetOptInputParameterInfo(info->handle, i, &opt) != TA_SUCCESS) panic();
+        std::vector<TA_Integer> integers;
+        std::vector<TA_Real> reals;
+        if (opt->type == TA_OptInput_IntegerRange) {
+            const TA_IntegerRange *range = static_cast<const TA_IntegerRange *>(opt->dataSet);
+            integers.push_back(range->min);
+            integers.push_back(std::min(TA_Integer(opt->defaultValue) + 3, range->max));
+        }
+        else if (opt->type == TA_OptInput_IntegerList) {
+            const TA_IntegerList *list = static_cast<const TA_IntegerList *>(opt->dataSet);
+            for (unsigned j = 0; j < list->nbElement; ++j) integers.push_back(list->data[j].value);
+        }
+        else if (opt->type == TA_OptInput_RealRange) {
+            const TA_RealRange *range = static_cast<const TA_RealRange *>(opt->dataSet);
+            TA_Real d = opt->defaultValue;
+            TA_Real candidates[] = { d != 0 ? d / 2 : 0.5, d * 2 };
+            for (unsigned j = 0; j < 2; ++j) {
+                reals.push_back(std::max(range->min, std::min(candidates[j], range->max)));
+            }
+        }
+        BOOST_FOREACH(TA_Integer v, integers) {
+            if (v == TA_Integer(opt->defaultValue)) continue;
+            Variant variant;
+            std::ostringstream label;
+            label << opt->paramName << '=' << v;
+            variant.label = label.str();
+            variant.options.add(opt->paramName, v);
+            r.push_back(variant);
+        }
+        BOOST_FOREACH(TA_Real v, reals) {
+            if (v == opt->defaultValue) continue;
+            Variant variant;
+            std::ostringstream label;
+            label << opt->paramName << '=' << v;
+            variant.label = label.str();
+            variant.options.add(opt->paramName, v);
+            r.push_back(variant);
+        }
+    }
+    return r;
+}
+
+/// Compute a function on candles, as validateFloat() does.
+template <typename T>
+BasicTA<T> compute (const TA_FuncInfo *info, const Candles &candles, const TA::Options &options)
+{
+    std::string name = info->name;
+    Series<T> close = cast<T>(candles.getClose());
+    if (info->nbInput == 1) {
+        if (isPriceInput(info, 0)) return BasicTA<T>(name, candles, options);
+        return BasicTA<T>(name, close, options);
+    }
+    verify(info->nbInput == 2);
+    bool p0 = isPriceInput(info, 0);
+    bool p1 = isPriceInput(info, 1);
+    if (p0 && p1) return BasicTA<T>(name, candles, candles, options);
+    if (p0) return BasicTA<T>(name, candles, close, options);
+    if (p1) return BasicTA<T>(name, close, candles, options);
+    Series<T> second = cast<T>(detail::secondInput(name, candles));
+    return BasicTA<T>(name, close, second, options);
+}
+
+void fail (const std::string &what, const std::string &output, TA_Integer i, double reference, double native)
+{
+    ++failures;
+    std::cout << what << '\t' << output << '\t' << i << '\t' << reference << '\t' << native << std::endl;
+}
+
+/// Compare a real series with a reference, relative to its largest value.
+/**
+ * If early is set, the series may start before the reference, as series
+ * functions without unstable period do, and only the elements of the
+ * reference are compared.
+ */
+template <typename T>
+void compareReal (const Series<T> &r, const Series<T> &n, double tolerance, const std::string &what,
+                  const std::string &output, bool early = false)
+{
+    ++checks;
+    bool first = early ? n.getFirst() <= r.getFirst() : n.getFirst() == r.getFirst();
+    if (!first || r.size() != n.size()) {
+        fail(what, output, -1, r.getFirst(), n.getFirst());
+        return;
+    }
+    double scale = 0;
+    for (TA_Integer i = r.getFirst(); i < TA_Integer(r.size()); ++i) {
+        scale = std::max(scale, std::fabs(double(r[i])));
+    }
+    for (TA_Integer i = r.getFirst(); i < TA_Integer(r.size()); ++i) {
+        double a = r[i], b = n[i];
+        if (!(std::fabs(a - b) <= tolerance * scale)) {
+            fail(what, output, i, a, b);
+            return;
+        }
+    }
+}
+
+/// Compare the native outputs of a function with TA-lib's.
+template <typename T>
+void compare (const BasicTA<T> &reference, const BasicTA<T> &native, double tolerance, const std::string &what)
+{
+    for (unsigned k = 0; k < reference.getOutputs().size(); ++k) {
+        const typename BasicTA<T>::Output &r = reference[k], &n = native[k];
+        if (r.type == TA_Output_Integer) {
+            ++checks;
+            if (r.integer.getFirst() != n.integer.getFirst() || r.integer.size() != n.integer.size()) {
+                fail(what, r.name, -1, r.integer.getFirst(), n.integer.getFirst());
+                continue;
+            }
+            for (TA_Integer i = r.integer.getFirst(); i < TA_Integer(r.integer.size()); ++i) {
+                if (r.integer[i] != n.integer[i]) {
+                    fail(what, r.name, i, r.integer[i], n.integer[i]);
+                    break;
+                }
+            }
+            continue;
+        }
+        compareReal(r.real, n.real, tolerance, what, r.name);
+    }
+}
+
+/// Check all native functions of a precision.
+template <typename T>
+void checkNative (const Config &config, const Candles &candles, double tolerance, const char *precision)
+{
+    for (unsigned f = 0; f < NativeTable<T>::size(); ++f) {
+        const TA_FuncInfo *info = funcInfo(NativeTable<T>::get(f).name);
+        BOOST_FOREACH(const Variant &variant, variants(info)) {
+            bool enabled = setNativeEnabled(false);
+            BasicTA<T> reference = compute<T>(info, candles, variant.options);
+            setNativeEnabled(true);
+            BasicTA<T> native = compute<T>(info, candles, variant.options);
+            setNativeEnabled(enabled);
+            std::string what = std::string(info->name) + '\t' + precision + '\t' + config.label + '\t' + variant.label;
+            compare(reference, native, tolerance, what);
+        }
+    }
+}
+
+/// Output k of a function of one input, computed by TA-lib.
+/**
+ * Integer outputs are converted to real.
+ */
+template <typename I>
+RealSeries reference (const std::string &name, const I &input, const TA::Options &options, unsigned k = 0)
+{
+    bool enabled = setNativeEnabled(false);
+    TA ta(name, input, options);
+    setNativeEnabled(enabled);
+    if (ta[k].type == TA_Output_Real) return ta[k].real;
+    RealSeries r;
+    r.resize(ta[k].integer.size());
+    r.setFirst(ta[k].integer.getFirst());
+    for (TA_Integer i = r.getFirst(); i < TA_Integer(r.size()); ++i) r[i] = ta[k].integer[i];
+    return r;
+}
+
+/// Output k of a function of two inputs, computed by TA-lib.
+template <typename I1, typename I2>
+RealSeries reference (const std::string &name, const I1 &input1, const I2 &input2, const TA::Options &options,
+                      unsigned k = 0)
+{
+    bool enabled = setNativeEnabled(false);
+    TA ta(name, input1, input2, options);
+    setNativeEnabled(enabled);
+    return ta[k].real;
+}
+
+TA::Options period (TA_Integer p)
+{
+    return TA::Options().add("optInTimePeriod", p);
+}
+
+std::string label (const char *function, const Config &config)
+{
+    return std::string(function) + "\tdouble\t" + config.label;
+}
+
+std::string label (const char *option, TA_Integer value)
+{
+    std::ostringstream r;
+    r << option << '=' << value;
+    return r.str();
+}
+
+/// Check emaRibbon() and smaRibbon() against TA of EMA and SMA.
+/**
+ * The ribbons have no unstable period, so EMA is compared where TA-lib
+ * has an output.
+ */
+void checkRibbons (const Config &config, const Candles &candles)
+{
+    const RealSeries &close = candles.getClose();
+    static const TA_Integer periods[] = { 2, 3, 5, 14, 30, 50, 200 };
+    std::vector<TA_Integer> p(periods, periods + sizeof(periods) / sizeof(periods[0]));
+    std::vector<RealSeries> ema = emaRibbon(close, p), sma = smaRibbon(close, p);
+    for (unsigned j = 0; j < p.size(); ++j) {
+        compareReal(reference("EMA", close, period(p[j])), ema[j], DOUBLE_TOLERANCE,
+                    label("emaRibbon", config), label("optInTimePeriod", p[j]), true);
+        compareReal(reference("SMA", close, period(p[j])), sma[j], DOUBLE_TOLERANCE,
+                    label("smaRibbon", config), label("optInTimePeriod", p[j]));
+    }
+}
+
+/// Check macd() on TA-lib's averages against TA-lib's averages of its line.
+/**
+ * macd() differs from TA("MACD") in the seed of the fast average, see
+ * there, so the reference is built from TA-lib's averages the same way.
+ */
+void checkMacd (const Config &config, const Candles &candles)
+{
+    const RealSeries &close = candles.getClose();
+    RealSeries fast = reference("EMA", close, period(12)), slow = reference("EMA", close, period(26));
+    static const TA_MAType types[] = { TA_MAType_EMA, TA_MAType_SMA, TA_MAType_WMA };
+    for (unsigned t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+        MacdSeries<TA_Real> r = macd(fast, slow, 9, types[t]);
+        RealSeries line;
+        line.resize(close.size());
+        line.setFirst(slow.getFirst());
+        for (TA_Integer i = line.getFirst(); i < TA_Integer(line.size()); ++i) line[i] = fast[i] - slow[i];
+        TA::Options options = period(9);
+        options.add("optInMAType", TA_Integer(types[t]));
+        RealSeries signal = reference("MA", line, options);
+        RealSeries hist;
+        hist.resize(signal.size());
+        hist.setFirst(signal.getFirst());
+        for (TA_Integer i = hist.getFirst(); i < TA_Integer(hist.size()); ++i) hist[i] = line[i] - signal[i];
+        line.setFirst(signal.getFirst());
+        std::string what = label("macd", config);
+        std::string type = label("optInMAType", types[t]);
+        compareReal(line, r.macd, DOUBLE_TOLERANCE, what, "macd\t" + type, true);
+        compareReal(signal, r.signal, DOUBLE_TOLERANCE, what, "signal\t" + type, true);
+        compareReal(hist, r.hist, DOUBLE_TOLERANCE, what, "hist\t" + type, true);
+    }
+}
+
+/// Check regression() against TA of the linear regression functions.
+void checkRegression (const Config &config, const Candles &candles)
+{
+    const RealSeries &close = candles.getClose();
+    static const char *const names[REGRESSION_OUTPUTS] = {
+        "LINEARREG", "LINEARREG_SLOPE", "LINEARREG_INTERCEPT", "LINEARREG_ANGLE", "TSF"
+    };
+    static const TA_Integer periods[] = { 2, 14, 100 };
+    for (unsigned j = 0; j < sizeof(periods) / sizeof(periods[0]); ++j) {
+        std::vector<RealSeries> r = regression(close, periods[j]);
+        for (int k = 0; k < REGRESSION_OUTPUTS; ++k) {
+            compareReal(reference(names[k], close, period(periods[j])), r[k], DOUBLE_TOLERANCE,
+                        label("regression", config), std::string(names[k]) + '\t' + label("optInTimePeriod", periods[j]));
+        }
+    }
+}
+
+/// Check correlations() and betas() against TA of CORREL and BETA.
+void checkComoments (const Config &config, const Candles &candles)
+{
+    const RealSeries &close = candles.getClose();
+    std::vector<RealSeries> series;
+    series.push_back(candles.getOpen());
+    series.push_back(candles.getHigh());
+    series.push_back(candles.getLow());
+    series.push_back(candles.getVolume());
+    static const TA_Integer periods[] = { 2, 5, 30 };
+    for (unsigned j = 0; j < sizeof(periods) / sizeof(periods[0]); ++j) {
+        std::vector<RealSeries> c = correlations(close, series, periods[j]), b = betas(close, series, periods[j]);
+        for (unsigned k = 0; k < series.size(); ++k) {
+            std::ostringstream output;
+            output << "series " << k << '\t' << label("optInTimePeriod", periods[j]);
+            compareReal(reference("CORREL", close, series[k], period(periods[j])), c[k], DOUBLE_TOLERANCE,
+                        label("correlations", config), output.str());
+            compareReal(reference("BETA", close, series[k], period(periods[j])), b[k], DOUBLE_TOLERANCE,
+                        label("betas", config), output.str());
+        }
+    }
+}
+
+/// Check hilbert() against TA of the Hilbert transform functions.
+void checkHilbert (const Config &config, const Candles &candles)
+{
+    const RealSeries &close = candles.getClose();
+    // The function and output of TA-lib of each HilbertOutput.
+    static const char *const names[HILBERT_OUTPUTS] = {
+        "HT_DCPERIOD", "HT_DCPHASE", "HT_PHASOR", "HT_PHASOR", "HT_SINE", "HT_SINE", "HT_TRENDLINE", "HT_TRENDMODE"
+    };
+    static const unsigned outputs[HILBERT_OUTPUTS] = { 0, 0, 0, 1, 0, 1, 0, 0 };
+    std::vector<RealSeries> r = hilbert(close);
+    for (int k = 0; k < HILBERT_OUTPUTS; ++k) {
+        std::ostringstream output;
+        output << names[k] << '\t' << outputs[k];
+        compareReal(reference(names[k], close, TA::Options(), outputs[k]), r[k], DOUBLE_TOLERANCE,
+                    label("hilbert", config), output.str());
+    }
+}
+
+/// Check volatility() against TA of TRANGE, ATR and NATR.
+void checkVolatility (const Config &config, const Candles &candles)
+{
+    static const TA_Integer periods[] = { 1, 2, 14 };
+    for (unsigned j = 0; j < sizeof(periods) / sizeof(periods[0]); ++j) {
+        std::vector<RealSeries> r = volatility(candles, periods[j]);
+        std::string p = label("optInTimePeriod", periods[j]);
+        compareReal(reference("TRANGE", candles, TA::Options()), r[VOLATILITY_TRANGE], DOUBLE_TOLERANCE,
+                    label("volatility", config), "TRANGE\t" + p);
+        compareReal(reference("ATR", candles, period(periods[j])), r[VOLATILITY_ATR], DOUBLE_TOLERANCE,
+                    label("volatility", config), "ATR\t" + p);
+        compareReal(reference("NATR", candles, period(periods[j])), r[VOLATILITY_NATR], DOUBLE_TOLERANCE,
+                    label("volatility", config), "NATR\t" + p);
+    }
+}
+
+/// Check volume() against TA of AD, ADOSC and OBV.
+void checkVolume (const Config &config, const Candles &candles)
+{
+    static const TA_Integer fasts[] = { 3, 2, 10 }, slows[] = { 10, 20, 3 };
+    for (unsigned j = 0; j < sizeof(fasts) / sizeof(fasts[0]); ++j) {
+        std::vector<RealSeries> r = volume(candles, fasts[j], slows[j]);
+        TA::Options options;
+        options.add("optInFastPeriod", fasts[j]).add("optInSlowPeriod", slows[j]);
+        std::string p = label("optInFastPeriod", fasts[j]) + ',' + label("optInSlowPeriod", slows[j]);
+        compareReal(reference("AD", candles, TA::Options()), r[VOLUME_AD], DOUBLE_TOLERANCE,
+                    label("volume", config), "AD");
+        compareReal(reference("ADOSC", candles, options), r[VOLUME_ADOSC], DOUBLE_TOLERANCE,
+                    label("volume", config), "ADOSC\t" + p);
+        compareReal(reference("OBV", candles.getClose(), candles, TA::Options()), r[VOLUME_OBV], DOUBLE_TOLERANCE,
+                    label("volume", config), "OBV");
+    }
+}
+
+/// A series like reference, to be filled bar by bar from a streaming state.
+RealSeries streamed (const RealSeries &reference)
+{
+    RealSeries r(reference);
+    std::fill(r.begin(), r.end(), 0);
+    return r;
+}
+
+/// Check VolatilityState bar by bar against volatility().
+void checkVolatilityState (const Config &config, const Candles &candles)
+{
+    std::vector<RealSeries> r = volatility(candles, 14);
+    std::vector<RealSeries> s(VOLATILITY_INDICATORS);
+    for (int k = 0; k < VOLATILITY_INDICATORS; ++k) s[k] = streamed(r[k]);
+    const RealSeries &high = candles.getHigh(), &low = candles.getLow(), &close = candles.getClose();
+    VolatilityState state(14);
+    for (TA_Integer i = close.getFirst(); i < TA_Integer(close.size()); ++i) {
+        state.push(high[i], low[i], close[i]);
+        double values[VOLATILITY_INDICATORS] = { state.getTrueRange(), state.getATR(), state.getNATR() };
+        for (int k = 0; k < VOLATILITY_INDICATORS; ++k) {
+            if (i >= r[k].getFirst()) s[k][i] = values[k];
+        }
+    }
+    static const char *const names[VOLATILITY_INDICATORS] = { "TRANGE", "ATR", "NATR" };
+    for (int k = 0; k < VOLATILITY_INDICATORS; ++k) {
+        compareReal(r[k], s[k], DOUBLE_TOLERANCE, std::string("VolatilityState\tdouble\t") + config.label, names[k]);
+    }
+}
+
+/// Check VolumeState bar by bar against volume().
+void checkVolumeState (const Config &config, const Candles &candles)
+{
+    std::vector<RealSeries> r = volume(candles, 3, 10);
+    std::vector<RealSeries> s(VOLUME_INDICATORS);
+    for (int k = 0; k < VOLUME_INDICATORS; ++k) s[k] = streamed(r[k]);
+    const RealSeries &high = candles.getHigh(), &low = candles.getLow(), &close = candles.getClose();
+    const RealSeries &volumes = candles.getVolume();
+    VolumeState state(3, 10);
+    for (TA_Integer i = close.getFirst(); i < TA_Integer(close.size()); ++i) {
+        state.push(high[i], low[i], close[i], volumes[i]);
+        double values[VOLUME_INDICATORS] = { state.getAD(), state.getADOSC(), state.getOBV() };
+        for (int k = 0; k < VOLUME_INDICATORS; ++k) {
+            if (i >= r[k].getFirst()) s[k][i] = values[k];
+        }
+    }
+    static const char *const names[VOLUME_INDICATORS] = { "AD", "ADOSC", "OBV" };
+    for (int k = 0; k < VOLUME_INDICATORS; ++k) {
+        compareReal(r[k], s[k], DOUBLE_TOLERANCE, std::string("VolumeState\tdouble\t") + config.label, names[k]);
+    }
+}
+
+/// Check HilbertState bar by bar against hilbert().
+/**
+ * As in TA-lib, the dominant cycle period and the phasor start their
+ * transform at HILBERT_PERIOD_START and the others at HILBERT_PHASE_START.
+ */
+void checkHilbertState (const Config &config, const Candles &candles)
+{
+    const RealSeries &close = candles.getClose();
+    std::vector<RealSeries> r = hilbert(close);
+    std::vector<RealSeries> s(HILBERT_OUTPUTS);
+    for (int k = 0; k < HILBERT_OUTPUTS; ++k) s[k] = streamed(r[k]);
+    const unsigned early = TAPP_HILBERT(HILBERT_DCPERIOD) | TAPP_HILBERT(HILBERT_INPHASE)
+        | TAPP_HILBERT(HILBERT_QUADRATURE);
+    HilbertState periodState(HILBERT_PERIOD_START, early), phaseState(HILBERT_PHASE_START, ~early);
+    for (TA_Integer i = close.getFirst(); i < TA_Integer(close.size()); ++i) {
+        periodState.push(close[i]);
+        phaseState.push(close[i]);
+        for (int k = 0; k < HILBERT_OUTPUTS; ++k) {
+            const HilbertState &state = early & TAPP_HILBERT(k) ? periodState : phaseState;
+            if (i >= r[k].getFirst()) s[k][i] = state.get(HilbertOutput(k));
+        }
+    }
+    static const char *const names[HILBERT_OUTPUTS] = {
+        "DCPERIOD", "DCPHASE", "INPHASE", "QUADRATURE", "SINE", "LEADSINE", "TRENDLINE", "TRENDMODE"
+    };
+    for (int k = 0; k < HILBERT_OUTPUTS; ++k) {
+        compareReal(r[k], s[k], DOUBLE_TOLERANCE, std::string("HilbertState\tdouble\t") + config.label, names[k]);
+    }
+}
+
+/// Check CandleScan against TA of each pattern.
+void checkCandles (const Config &config, const Candles &candles, const CandleSettings &settings, const char *label)
+{
+    CandleScan scan(candles, ALL_CANDLE_PATTERNS, settings);
+    settings.apply();
+    for (int k = 0; k < CANDLE_PATTERNS; ++k) {
+        ++checks;
+        CandlePattern pattern = CandlePattern(k);
+        TA ta(candlePatternName(pattern), candles);
+        const IntegerSeries &r = ta[0].integer;
+        for (TA_Integer i = 0; i < TA_Integer(candles.size()); ++i) {
+            TA_Integer expected = i >= r.getFirst() ? r[i] : 0;
+            if (scan.get(i, pattern) != expected) {
+                fail(std::string(candlePatternName(pattern)) + "\tscan\t" + config.label + '\t' + label,
+                     "outInteger", i, expected, scan.get(i, pattern));
+                break;
+            }
+        }
+    }
+}
+
+}
+
+int main ()
+{
+    TA_Initialize();
+
+    static const Config configs[] = {
+        { "default", TA_COMPATIBILITY_DEFAULT, 0, 0 },
+        { "first=37", TA_COMPATIBILITY_DEFAULT, 0, 37 },
+        { "unstable=25", TA_COMPATIBILITY_DEFAULT, 25, 0 },
+        { "metastock", TA_COMPATIBILITY_METASTOCK, 0, 0 },
+        { "metastock,unstable=25,first=37", TA_COMPATIBILITY_METASTOCK, 25, 37 }
+    };
+
+    CandleSettings other;
+    other.set(TA_BodyLong, TA_RangeType_HighLow, 5, 0.6)
+         .set(TA_BodyShort, TA_RangeType_RealBody, 7, 0.8)
+         .set(TA_BodyDoji, TA_RangeType_RealBody, 3, 0.2)
+         .set(TA_ShadowLong, TA_RangeType_RealBody, 4, 1.5)
+         .set(TA_ShadowVeryShort, TA_RangeType_Shadows, 0, 0.3)
+         .set(TA_Near, TA_RangeType_Shadows, 0, 0.3)
+         .set(TA_Equal, TA_RangeType_RealBody, 8, 0.1);
+
+    for (unsigned c = 0; c < sizeof(configs) / sizeof(configs[0]); ++c) {
+        const Config &config = configs[c];
+        if (TA_SetCompatibility(config.compatibility) != TA_SUCCESS) panic();
+        if (TA_SetUnstablePeriod(TA_FUNC_UNST_ALL, config.unstable) != TA_SUCCESS) panic();
+        Candles candles = makeCandles(2000, config.first);
+        checkNative<TA_Real>(config, candles, DOUBLE_TOLERANCE, "double");
+        checkNative<float>(config, detail::floatInput(candles), FLOAT_TOLERANCE, "float");
+        checkRibbons(config, candles);
+        checkMacd(config, candles);
+        checkRegression(config, candles);
+        checkComoments(config, candles);
+        checkHilbert(config, candles);
+        checkVolatility(config, candles);
+        checkVolume(config, candles);
+        checkVolatilityState(config, candles);
+        checkHilbertState(config, candles);
+        checkVolumeState(config, candles);
+        checkCandles(config, candles, CandleSettings(), "default settings");
+        checkCandles(config, candles, other, "other settings");
+    }
+    CandleSettings().apply();
+    TA_SetCompatibility(TA_COMPATIBILITY_DEFAULT);
+    TA_SetUnstablePeriod(TA_FUNC_UNST_ALL, 0);
+
+    std::cout << checks << " checks, " << failures << " failures" << std::endl;
+    TA_Shutdown();
+    return failures == 0 ? 0 : 1;
+}
@@ -47,10 +47,15 @@ int main ()
     //      TA::getDefault().add(name, value).add(name, value)...;
     // Too see a list of optional parameters of various TA indicators,
     // see the file ta-list in the package.
-    TA ma5("EMA", candles.getClose(), TA::getDefault().add("optInTimePeriod", 5));
-    TA ma10("EMA", candles.getClose(), TA::getDefault().add("optInTimePeriod", 10));
-    TA ma30("EMA", candles.getClose(), TA::getDefault().add("optInTimePeriod", 30));
-    TA ma60("EMA", candles.getClose(), TA::getDefault().add("optInTimePeriod", 60));
+    //
+    // Moving averages of several periods over the same input are cheaper
+    // to compute together in one pass.  emaRibbon returns one series for
+    // each period, the same as
+    //      TA("EMA", candles.getClose(), TA::getDefault().add("optInTimePeriod", 5));
+    // and so on.
+    TA_Integer periods[] = {5, 10, 30, 60};
+    std::vector<RealSeries> ma = emaRibbon(candles.getClose(),
+            std::vector<TA_Integer>(periods, periods + 4));
 
     // GnuplotChart generate gnuplot scripts.  The output will be stored in "C.gp".
     // The constructor automatically generate two panes: pane0 for the candles and
@@ -60,10 +65,10 @@ int main ()
     // c.png is the image file that should be generated by running the Gnuplot script.
     GnuplotChart chart("C", candles, "c.gp", "c.png");
     // Draw the moving averages on pane 0.
-    chart.getPane(0)->draw(ma5, "MA5");
-    chart.getPane(0)->draw(ma10, "MA10");
-    chart.getPane(0)->draw(ma30, "MA30");
-    chart.getPane(0)->draw(ma60, "MA60");
+    chart.getPane(0)->draw("MA5", ma[0]);
+    chart.getPane(0)->draw("MA10", ma[1]);
+    chart.getPane(0)->draw("MA30", ma[2]);
+    chart.getPane(0)->draw("MA60", ma[3]);
     // Add a MACD pane.
     chart.addPane("MACD")->draw(macd);
     // Generate the output.
@@ -0,0 +1,361 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_COST
+#define WDONG_TAPP_COST
+
+/**
+ * \file ta++-cost.h
+ * \brief Cost model of TA functions for scheduling batch work.
+ *
+ * TA functions differ a lot in cost: MAMA and the HT_* functions take many
+ * times longer than SMA over the same series.  When a batch of functions
+ * and series is split among threads in submission order, an expensive job
+ * near the end keeps one thread busy while the others idle.  Ordering the
+ * jobs longest first and assigning each to the least loaded thread (the
+ * LPT rule) keeps the makespan within 4/3 of the optimum.
+ *
+ * The cost of a function over a series of n elements is modeled as
+ * overhead + n * perElement, where the overhead is shared by all functions.
+ * Per element costs come from two sources:
+ * <ul>
+ * <li> calibrate() times every TA-lib function on a sample of candles.
+ * </li>
+ * <li> With setCostLearning(true), every TA computation is timed and folded
+ * into the model with an exponential moving average.  The model takes a
+ * lock around every access, so threads may compute and learn concurrently.
+ * </li>
+ * </ul>
+ * Functions not measured yet are assumed to cost the average of those
+ * measured, or defaultPerElement() if none is.
+ *
+ * This file is included by ta++.h and should not be included directly.
+ */
+
+#include <map>
+#include <algorithm>
+#include <time.h>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/detail/lightweight_mutex.hpp>
+
+namespace tapp {
+
+namespace detail {
+
+/// The lock of the cost model.
+/**
+ * boost's header-only mutex: a pthread mutex, or a critical section on
+ * Windows, which blocks rather than spins while another thread updates the
+ * model.  Copies get a lock of their own, so that a model can be copied
+ * while another thread holds the lock of the original.
+ */
+class CostLock {
+    boost::detail::lightweight_mutex m;
+    friend class CostGuard;
+public:
+    CostLock () {
+    }
+    CostLock (const CostLock &) {
+    }
+    CostLock &operator = (const CostLock &) {
+        return *this;
+    }
+};
+
+/// Holds a CostLock for a scope.
+class CostGuard {
+    boost::detail::lightweight_mutex::scoped_lock l;
+    CostGuard (const CostGuard &);
+    CostGuard &operator = (const CostGuard &);
+public:
+    CostGuard (CostLock &lock): l(lock.m) {
+    }
+};
+
+}
+
+/// A unit of batch work: one TA function over one series.
+struct CostJob {
+    std::string function;
+    size_t size;
+
+    CostJob (const std::string &f = std::string(), size_t s = 0): function(f), size(s) {
+    }
+};
+
+/// Per function cost model.
+class CostModel {
+public:
+    /// Seconds per element assumed when nothing is measured.
+    static double defaultPerElement () {
+        return 1e-8;
+    }
+
+    /// Measured cost of one function.
+    struct Cost {
+        /// Seconds per input element.
+        double perElement;
+        /// Number of timings the cost is based on.
+        unsigned samples;
+    };
+
+private:
+    typedef std::map<std::string, Cost> CostMap;
+    CostMap costs;
+    double overhead;
+    double decay;
+    double minChunk;
+    mutable detail::CostLock mutex;
+
+    struct Longer {
+        const std::vector<double> &cost;
+        Longer (const std::vector<double> &c): cost(c) {
+        }
+        bool operator () (size_t a, size_t b) const {
+            return cost[a] > cost[b];
+        }
+    };
+
+    double elementCost (size_t size, double seconds) const {
+        return std::max(seconds - overhead, 0.0) / size;
+    }
+
+    void setLocked (const std::string &function, double perElement) {
+        Cost &c = costs[function];
+        c.perElement = perElement;
+        c.samples = 1;
+    }
+
+public:
+    /**
+     * @param overhead Seconds per call independent of the input size.
+     * @param decay Weight of a new timing in the moving average.
+     * @param minChunk Minimal seconds of work in a chunk, see chunkSize().
+     */
+    CostModel (double _overhead = 1e-6, double _decay = 0.1, double _minChunk = 1e-4)
+        : overhead(_overhead), decay(_decay), minChunk(_minChunk) {
+    }
+
+    /// Set the cost of a function, replacing what was learned.
+    void set (const std::string &function, double perElement) {
+        detail::CostGuard guard(mutex);
+        setLocked(function, perElement);
+    }
+
+    /// Set the cost of a function from one timing, replacing what was learned.
+    void measure (const std::string &function, size_t size, double seconds) {
+        if (size == 0) return;
+        set(function, elementCost(size, seconds));
+    }
+
+    /// Record the time one computation took.
+    void record (const std::string &function, size_t size, double seconds) {
+        if (size == 0) return;
+        double perElement = elementCost(size, seconds);
+        detail::CostGuard guard(mutex);
+        CostMap::iterator it = costs.find(function);
+        if (it == costs.end()) {
+            setLocked(function, perElement);
+            return;
+        }
+        Cost &c = it->second;
+        c.perElement += decay * (perElement - c.perElement);
+        ++c.samples;
+    }
+
+    /// Forget all measured costs.
+    void clear () {
+        detail::CostGuard guard(mutex);
+        costs.clear();
+    }
+
+    /// Get a copy of the measured costs.
+    std::map<std::string, Cost> getCosts () const {
+        detail::CostGuard guard(mutex);
+        return costs;
+    }
+
+    /// Seconds per element of a function.
+    double perElement (const std::string &function) const {
+        detail::CostGuard guard(mutex);
+        CostMap::const_iterator it = costs.find(function);
+        if (it != costs.end()) return it->second.perElement;
+        if (costs.empty()) return defaultPerElement();
+        double sum = 0;
+        for (it = costs.begin(); it != costs.end(); ++it) sum += it->second.perElement;
+        return sum / costs.size();
+    }
+
+    /// Estimated seconds of a function over a series.
+    double estimate (const std::string &function, size_t size) const {
+        return overhead + size * perElement(function);
+    }
+
+    /// Estimated seconds of a job.
+    double estimate (const CostJob &job) const {
+        return estimate(job.function, job.size);
+    }
+
+    /// Order jobs longest first.
+    /**
+     * Returns the indices of the jobs in the order they should be started.
+     */
+    std::vector<size_t> order (const std::vector<CostJob> &jobs) const {
+        std::vector<double> cost(jobs.size());
+        std::vector<size_t> idx(jobs.size());
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            cost[i] = estimate(jobs[i]);
+            idx[i] = i;
+        }
+        std::stable_sort(idx.begin(), idx.end(), Longer(cost));
+        return idx;
+    }
+
+    /// Assign jobs to workers statically.
+    /**
+     * Jobs are taken longest first, each going to the worker with the least
+     * estimated load.  Returns the indices of the jobs of each worker.
+     */
+    std::vector<std::vector<size_t> > assign (const std::vector<CostJob> &jobs, unsigned workers) const {
+        verify(workers > 0);
+        std::vector<std::vector<size_t> > r(workers);
+        std::vector<double> load(workers, 0);
+        std::vector<size_t> idx = order(jobs);
+        BOOST_FOREACH(size_t i, idx) {
+            unsigned w = std::min_element(load.begin(), load.end()) - load.begin();
+            r[w].push_back(i);
+            load[w] += estimate(jobs[i]);
+        }
+        return r;
+    }
+
+    /// Number of series per chunk when a function runs over many series.
+    /**
+     * Workers taking chunks dynamically balance best with many small
+     * chunks, but every chunk costs some scheduling.  The chunk size aims at
+     * four chunks per worker, enlarged until a chunk has at least minChunk
+     * seconds of work.
+     */
+    size_t chunkSize (const std::string &function, size_t size, size_t count, unsigned workers) const {
+        verify(workers > 0);
+        if (count == 0) return 1;
+        size_t chunk = (count + workers * 4 - 1) / (workers * 4);
+        double cost = estimate(function, size);
+        if (chunk * cost < minChunk) {
+            // Free jobs, or too many to reach minChunk, make a single chunk.
+            if (cost <= 0 || minChunk / cost >= count) return count;
+            chunk = size_t(minChunk / cost) + 1;
+        }
+        return std::min(chunk, count);
+    }
+};
+
+namespace detail {
+
+/// Seconds from an arbitrary origin.
+/**
+ * The monotonic POSIX clock where there is one, otherwise the wall clock of
+ * boost::posix_time.
+ */
+static inline double costClock () {
+#ifdef CLOCK_MONOTONIC
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    using namespace boost::posix_time;
+    static const ptime origin(microsec_clock::universal_time());
+    return (microsec_clock::universal_time() - origin).total_microseconds() * 1e-6;
+#endif
+}
+
+}
+
+/// The cost model shared by all translation units.
+inline CostModel &costModel () {
+    static CostModel model;
+    return model;
+}
+
+static inline void learnCost (const std::string &function, size_t size, double seconds) {
+    costModel().record(function, size, seconds);
+}
+
+/// Enable or disable learning costs from TA computations.
+/**
+ * Learning is disabled by default.  Returns the previous setting.
+ */
+static inline bool setCostLearning (bool enabled) {
+    bool old = detail::costLearning();
+    detail::costLearning() = enabled;
+    return old;
+}
+
+/// Calibrate the cost model on sample candles.
+/**
+ * Every TA-lib function is run rounds times with its default options, with
+ * inputs chosen as by validateFloat(), and the fastest run is recorded.
+ */
+static inline void calibrate (CostModel &model, const Candles &candles, unsigned rounds = 3)
+{
+    std::vector<std::string> names;
+    if (TA_ForEachFunc(detail::collectFunction, &names) != TA_SUCCESS) panic();
+    bool learning = setCostLearning(false);
+    size_t size = candles.size();
+    BOOST_FOREACH(const std::string &name, names) {
+        const TA_FuncHandle *handle;
+        const TA_FuncInfo *info;
+        if (TA_GetFuncHandle(name.c_str(), &handle) != TA_SUCCESS) panic();
+        if (TA_GetFuncInfo(handle, &info) != TA_SUCCESS) panic();
+        if (info->nbInput > 2) continue;
+        RealSeries second;
+        if (info->nbInput == 2) second = detail::secondInput(name, candles);
+        double best = -1;
+        for (unsigned r = 0; r < rounds; ++r) {
+            double start = detail::costClock();
+            if (info->nbInput == 1) {
+                if (detail::isPriceInput(info, 0)) TA(name, candles);
+                else TA(name, candles.getClose());
+            }
+            else {
+                bool p0 = detail::isPriceInput(info, 0);
+                bool p1 = detail::isPriceInput(info, 1);
+                if (p0 && p1) TA(name, candles, candles);
+                else if (p0) TA(name, candles, candles.getClose());
+                else if (p1) TA(name, candles.getClose(), candles);
+                else TA(name, candles.getClose(), second);
+            }
+            double t = detail::costClock() - start;
+            if (best < 0 || t < best) best = t;
+        }
+        model.measure(name, size, best);
+    }
+    setCostLearning(learning);
+}
+
+/// Calibrate the shared cost model.
+static inline void calibrate (const Candles &candles, unsigned rounds = 3)
+{
+    calibrate(costModel(), candles, rounds);
+}
+
+}
+
+#endif
+
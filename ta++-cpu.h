@@ -0,0 +1,172 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_CPU
+#define WDONG_TAPP_CPU
+
+/**
+ * \file ta++-cpu.h
+ * \brief Runtime selection of the instruction set used by native kernels.
+ *
+ * The library is header only and usually compiled for a generic target.  To
+ * still make use of wide vector units, every hot native loop that vectorizes
+ * is written as a kernel functor and run through dispatch(), which compiles
+ * the kernel once per instruction set level (scalar, SSE4.2, AVX2, AVX-512)
+ * and picks the best one the CPU supports when it is called.  The CPU is probed once, the
+ * first time a kernel runs.
+ *
+ * The level can be overridden, which is mostly useful for testing: set the
+ * environment variable TAPP_CPU to one of "scalar", "sse4.2", "avx2" or
+ * "avx512", or call setCpuLevel().  A level above what the CPU supports is
+ * clamped to the supported one.
+ *
+ * The AVX-512 level implies FMA, so the compiler may contract a * b + c into
+ * a single rounding and results can differ from the other levels in the
+ * last bit.  Build with -ffp-contract=off if bitwise agreement between
+ * levels matters.
+ *
+ * Dispatching requires GCC or a compatible compiler on x86.  Elsewhere, or
+ * when TAPP_NO_DISPATCH is defined, kernels are simply compiled for the
+ * default target.
+ *
+ * This file is included by ta++.h and should not be included directly.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(TAPP_NO_DISPATCH)
+#define TAPP_DISPATCH 1
+#define TAPP_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TAPP_TARGET_AVX2 __attribute__((target("avx2")))
+#define TAPP_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define TAPP_DISPATCH 0
+#endif
+
+#if defined(__GNUC__)
+/// Force a kernel body to be inlined into each instruction set variant.
+#define TAPP_INLINE inline __attribute__((always_inline))
+#define TAPP_NOINLINE __attribute__((noinline))
+#else
+#define TAPP_INLINE inline
+#define TAPP_NOINLINE
+#endif
+
+namespace tapp {
+
+/// Instruction set levels of native kernels.
+enum CpuLevel {
+    CPU_SCALAR,
+    CPU_SSE42,
+    CPU_AVX2,
+    CPU_AVX512
+};
+
+/// Name of an instruction set level, as accepted by TAPP_CPU.
+static inline const char *cpuLevelName (CpuLevel level) {
+    switch (level) {
+    case CPU_SSE42: return "sse4.2";
+    case CPU_AVX2: return "avx2";
+    case CPU_AVX512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+/// Probe the best instruction set level supported by the CPU.
+static inline CpuLevel detectCpuLevel () {
+#if TAPP_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return CPU_AVX512;
+    if (__builtin_cpu_supports("avx2")) return CPU_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return CPU_SSE42;
+#endif
+    return CPU_SCALAR;
+}
+
+namespace detail {
+
+static inline CpuLevel initialCpuLevel () {
+    CpuLevel level = detectCpuLevel();
+    const char *env = std::getenv("TAPP_CPU");
+    if (env == 0) return level;
+    for (int i = CPU_SCALAR; i < level; ++i) {
+        if (std::strcmp(env, cpuLevelName(CpuLevel(i))) == 0) return CpuLevel(i);
+    }
+    return level;
+}
+
+// Not static: the level is shared by all translation units.
+inline CpuLevel &cpuLevel () {
+    static CpuLevel level = initialCpuLevel();
+    return level;
+}
+
+}
+
+/// Get the instruction set level used by native kernels.
+static inline CpuLevel getCpuLevel () {
+    return detail::cpuLevel();
+}
+
+/// Override the instruction set level used by native kernels.
+/**
+ * Returns the level actually in effect, which is never above what the CPU
+ * supports.
+ */
+static inline CpuLevel setCpuLevel (CpuLevel level) {
+    CpuLevel best = detectCpuLevel();
+    detail::cpuLevel() = level < best ? level : best;
+    return detail::cpuLevel();
+}
+
+namespace detail {
+
+template <typename K> TAPP_NOINLINE void runScalar (const K &k) { k(); }
+#if TAPP_DISPATCH
+template <typename K> TAPP_NOINLINE TAPP_TARGET_SSE42 void runSse42 (const K &k) { k(); }
+template <typename K> TAPP_NOINLINE TAPP_TARGET_AVX2 void runAvx2 (const K &k) { k(); }
+template <typename K> TAPP_NOINLINE TAPP_TARGET_AVX512 void runAvx512 (const K &k) { k(); }
+#endif
+
+}
+
+/// Run a kernel with the selected instruction set level.
+/**
+ * A kernel is a functor with a const operator () declared TAPP_INLINE.  The
+ * functor is copied by reference only, and whatever it computes should be
+ * written through pointers it holds.
+ */
+template <typename K>
+inline void dispatch (const K &k) {
+#if TAPP_DISPATCH
+    switch (getCpuLevel()) {
+    case CPU_AVX512: detail::runAvx512(k); return;
+    case CPU_AVX2: detail::runAvx2(k); return;
+    case CPU_SSE42: detail::runSse42(k); return;
+    default: break;
+    }
+#endif
+    detail::runScalar(k);
+}
+
+}
+
+#endif
+
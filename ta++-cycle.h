@@ -0,0 +1,477 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_CYCLE
+#define WDONG_TAPP_CYCLE
+
+/**
+ * \file ta++-cycle.h
+ * \brief Native Hilbert transform indicators.
+ *
+ * HT_DCPERIOD, HT_DCPHASE, HT_PHASOR, HT_SINE, HT_TRENDMODE and, from
+ * the overlap group of TA-lib, HT_TRENDLINE all run the same Hilbert
+ * transform of the smoothed price.  HilbertState runs it once per bar and
+ * derives any subset of their outputs.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+namespace tapp {
+
+/// Outputs of the Hilbert transform indicators, see HilbertState.
+enum HilbertOutput {
+    HILBERT_DCPERIOD, HILBERT_DCPHASE, HILBERT_INPHASE, HILBERT_QUADRATURE,
+    HILBERT_SINE, HILBERT_LEADSINE, HILBERT_TRENDLINE, HILBERT_TRENDMODE, HILBERT_OUTPUTS
+};
+
+/// Bit of a Hilbert transform output in the mask of HilbertState and hilbert().
+#define TAPP_HILBERT(_output) (1u << (_output))
+
+/// First bar of the transform in HT_DCPERIOD and HT_PHASOR.
+static const TA_Integer HILBERT_PERIOD_START = 12;
+
+/// First bar of the transform in the other Hilbert transform indicators.
+static const TA_Integer HILBERT_PHASE_START = 37;
+
+namespace native {
+
+/// Sines and cosines of the dominant cycle phase.
+/**
+ * For the phase TA-lib correlates the last p smoothed prices with the sine
+ * and cosine of 2 pi i / p, i < p, where p <= 50 is the rounded dominant
+ * cycle period.  That is up to 100 calls of sin and cos per bar, while
+ * only 1275 distinct angles exist.  The table holds their sines and
+ * cosines, evaluated as TA-lib does.
+ */
+struct HilbertTable {
+    enum { PERIODS = 51 };
+
+    double sine[PERIODS * (PERIODS - 1) / 2];
+    double cosine[PERIODS * (PERIODS - 1) / 2];
+
+    HilbertTable () {
+        const double deg2RadBy360 = std::atan(1.0) * 8.0;
+        for (TA_Integer p = 1; p < PERIODS; ++p) {
+            for (TA_Integer i = 0; i < p; ++i) {
+                double angle = (double(i) * deg2RadBy360) / double(p);
+                sine[offset(p) + i] = std::sin(angle);
+                cosine[offset(p) + i] = std::cos(angle);
+            }
+        }
+    }
+
+    /// Index of the angles of period p.
+    static TA_Integer offset (TA_Integer p) {
+        return p * (p - 1) / 2;
+    }
+};
+
+// Not static: the table is shared by all translation units.
+inline const HilbertTable &hilbertTable () {
+    static const HilbertTable table;
+    return table;
+}
+
+}
+
+/// Hilbert transform indicators of live bars.
+/**
+ * The state takes one price at a time and updates the outputs in mask, a
+ * combination of TAPP_HILBERT bits, in constant time.  The transform
+ * starts at bar start: TA-lib starts it at HILBERT_PERIOD_START for
+ * HT_DCPERIOD and HT_PHASOR, and at HILBERT_PHASE_START for the others.
+ * With the same start, the outputs are those of TA-lib at every bar from
+ * its lookback on, without unstable period.  The transform converges, so
+ * the outputs of either start approach those of the other.
+ */
+class HilbertState
+{
+    enum { HISTORY = 64 };
+
+    // One Hilbert transform, with TA-lib's separate states for even and
+    // odd bars.
+    struct Transform {
+        double value;
+        double history[2][3];
+        double previous[2], previousInput[2];
+
+        Transform (): value(0) {
+            for (int p = 0; p < 2; ++p) {
+                history[p][0] = history[p][1] = history[p][2] = 0;
+                previous[p] = previousInput[p] = 0;
+            }
+        }
+
+        void update (double input, int parity, int index, double adjust) {
+            double t = 0.0962 * input;
+            value = -history[parity][index];
+            history[parity][index] = t;
+            value += t;
+            value -= previous[parity];
+            previous[parity] = 0.5769 * previousInput[parity];
+            value += previous[parity];
+            previousInput[parity] = input;
+            value *= adjust;
+        }
+    };
+
+    TA_Integer start, count;
+    bool phase, trend;
+    // Prices and smoothed prices of the last bars.
+    double price[HISTORY], smoothPrice[HISTORY];
+    double wmaSub, wmaSum, wmaTrailing;
+    Transform detrender, q1, jI, jQ;
+    int index;
+    // Detrender delayed by 2 and 3 bars, as used by even and odd bars.
+    double i1Prev2[2], i1Prev3[2];
+    double prevI2, prevQ2, re, im, period, smoothPeriod;
+    double inPhase, quadrature, dcPhase, sine, leadSine, trendline;
+    double iTrend[3];
+    TA_Integer daysInTrend, trendMode;
+
+    void updatePhase () {
+        const double rad2Deg = 45.0 / std::atan(1.0);
+        const native::HilbertTable &table = native::hilbertTable();
+        TA_Integer p = std::min(TA_Integer(smoothPeriod + 0.5), TA_Integer(native::HilbertTable::PERIODS - 1));
+        const double *s = table.sine + table.offset(p);
+        const double *c = table.cosine + table.offset(p);
+        double realPart = 0, imagPart = 0;
+        for (TA_Integer i = 0; i < p; ++i) {
+            double v = smoothPrice[(count - i) & (HISTORY - 1)];
+            realPart += s[i] * v;
+            imagPart += c[i] * v;
+        }
+        if (std::fabs(imagPart) > 0.0) dcPhase = std::atan(realPart / imagPart) * rad2Deg;
+        else if (realPart < 0.0) dcPhase -= 90.0;
+        else if (realPart > 0.0) dcPhase += 90.0;
+        dcPhase += 90.0;
+        // Compensate for the lag of the smoothing.
+        dcPhase += 360.0 / smoothPeriod;
+        if (imagPart < 0.0) dcPhase += 180.0;
+        if (dcPhase > 315.0) dcPhase -= 360.0;
+        const double deg2Rad = 1.0 / rad2Deg;
+        sine = std::sin(dcPhase * deg2Rad);
+        leadSine = std::sin((dcPhase + 45) * deg2Rad);
+    }
+
+    void updateTrendline () {
+        TA_Integer p = TA_Integer(smoothPeriod + 0.5);
+        double average = 0;
+        for (TA_Integer i = 0; i < p; ++i) average += price[(count - i) & (HISTORY - 1)];
+        if (p > 0) average = average / double(p);
+        trendline = (4.0 * average + 3.0 * iTrend[0] + 2.0 * iTrend[1] + iTrend[2]) / 10.0;
+        iTrend[2] = iTrend[1];
+        iTrend[1] = iTrend[0];
+        iTrend[0] = average;
+    }
+
+public:
+    HilbertState (TA_Integer _start = HILBERT_PHASE_START, unsigned mask = ~0u)
+        : start(std::max(_start, TA_Integer(3))), count(0),
+        phase(mask & (TAPP_HILBERT(HILBERT_DCPHASE) | TAPP_HILBERT(HILBERT_SINE)
+                      | TAPP_HILBERT(HILBERT_LEADSINE) | TAPP_HILBERT(HILBERT_TRENDMODE))),
+        trend(mask & (TAPP_HILBERT(HILBERT_TRENDLINE) | TAPP_HILBERT(HILBERT_TRENDMODE))),
+        wmaSub(0), wmaSum(0), wmaTrailing(0), index(0),
+        prevI2(0), prevQ2(0), re(0), im(0), period(0), smoothPeriod(0),
+        inPhase(0), quadrature(0), dcPhase(0), sine(0), leadSine(0), trendline(0),
+        daysInTrend(0), trendMode(0) {
+        for (int i = 0; i < HISTORY; ++i) price[i] = smoothPrice[i] = 0;
+        i1Prev2[0] = i1Prev2[1] = i1Prev3[0] = i1Prev3[1] = 0;
+        iTrend[0] = iTrend[1] = iTrend[2] = 0;
+    }
+
+    /// Add the next price.
+    void push (double value) {
+        const double rad2Deg = 45.0 / std::atan(1.0);
+        price[count & (HISTORY - 1)] = value;
+        // Weighted moving average of the last 4 prices.
+        if (count < 3) {
+            wmaSub += value;
+            wmaSum += value * double(count + 1);
+            ++count;
+            return;
+        }
+        wmaSub += value;
+        wmaSub -= wmaTrailing;
+        wmaSum += value * 4.0;
+        wmaTrailing = price[(count - 3) & (HISTORY - 1)];
+        double smoothed = wmaSum * 0.1;
+        wmaSum -= wmaSub;
+        if (count < start) {
+            ++count;
+            return;
+        }
+
+        double adjust = (0.075 * period) + 0.54;
+        int parity = count % 2;
+        smoothPrice[count & (HISTORY - 1)] = smoothed;
+        detrender.update(smoothed, parity, index, adjust);
+        q1.update(detrender.value, parity, index, adjust);
+        inPhase = i1Prev3[parity];
+        quadrature = q1.value;
+        jI.update(inPhase, parity, index, adjust);
+        jQ.update(q1.value, parity, index, adjust);
+        if (parity == 0 && ++index == 3) index = 0;
+        double q2 = (0.2 * (q1.value + jI.value)) + (0.8 * prevQ2);
+        double i2 = (0.2 * (inPhase - jQ.value)) + (0.8 * prevI2);
+        i1Prev3[1 - parity] = i1Prev2[1 - parity];
+        i1Prev2[1 - parity] = detrender.value;
+
+        // Adjust the period for the next bar.
+        re = (0.2 * ((i2 * prevI2) + (q2 * prevQ2))) + (0.8 * re);
+        im = (0.2 * ((i2 * prevQ2) - (q2 * prevI2))) + (0.8 * im);
+        prevQ2 = q2;
+        prevI2 = i2;
+        double previous = period;
+        if (im != 0.0 && re != 0.0) period = 360.0 / (std::atan(im / re) * rad2Deg);
+        if (period > 1.5 * previous) period = 1.5 * previous;
+        if (period < 0.67 * previous) period = 0.67 * previous;
+        if (period < 6) period = 6;
+        else if (period > 50) period = 50;
+        period = (0.2 * period) + (0.8 * previous);
+        smoothPeriod = (0.33 * period) + (0.67 * smoothPeriod);
+
+        double previousPhase = dcPhase, previousSine = sine, previousLeadSine = leadSine;
+        if (phase) updatePhase();
+        if (trend) updateTrendline();
+        if (phase && trend) {
+            // Trend by default, but not right after the sine and the lead
+            // sine cross, nor while the phase advances at the cycle rate,
+            // unless the price is far from the trendline.
+            trendMode = 1;
+            if ((sine > leadSine && previousSine <= previousLeadSine) ||
+                (sine < leadSine && previousSine >= previousLeadSine)) {
+                daysInTrend = 0;
+                trendMode = 0;
+            }
+            ++daysInTrend;
+            if (daysInTrend < 0.5 * smoothPeriod) trendMode = 0;
+            double change = dcPhase - previousPhase;
+            if (smoothPeriod != 0.0 && change > 0.67 * 360.0 / smoothPeriod && change < 1.5 * 360.0 / smoothPeriod) {
+                trendMode = 0;
+            }
+            if (trendline != 0.0 && std::fabs((smoothed - trendline) / trendline) >= 0.015) trendMode = 1;
+        }
+        ++count;
+    }
+
+    /// Number of prices added.
+    TA_Integer size () const {
+        return count;
+    }
+
+    /// Get an output as a real number.
+    double get (HilbertOutput output) const {
+        switch (output) {
+        case HILBERT_DCPERIOD: return smoothPeriod;
+        case HILBERT_DCPHASE: return dcPhase;
+        case HILBERT_INPHASE: return inPhase;
+        case HILBERT_QUADRATURE: return quadrature;
+        case HILBERT_SINE: return sine;
+        case HILBERT_LEADSINE: return leadSine;
+        case HILBERT_TRENDLINE: return trendline;
+        case HILBERT_TRENDMODE: return trendMode;
+        default: panic("no Hilbert transform output %d\n", int(output));
+        }
+        return 0;
+    }
+
+    double getDCPeriod () const {
+        return smoothPeriod;
+    }
+
+    double getDCPhase () const {
+        return dcPhase;
+    }
+
+    double getInPhase () const {
+        return inPhase;
+    }
+
+    double getQuadrature () const {
+        return quadrature;
+    }
+
+    double getSine () const {
+        return sine;
+    }
+
+    double getLeadSine () const {
+        return leadSine;
+    }
+
+    double getTrendline () const {
+        return trendline;
+    }
+
+    /// 1 in a trend and 0 in a cycle.
+    TA_Integer getTrendMode () const {
+        return trendMode;
+    }
+};
+
+namespace native {
+
+/// Hilbert transform kernel.
+/**
+ * Runs the transform once from bar start and writes every output k of
+ * out, indexed by HilbertOutput, from input element begin[k] on.  The
+ * trend mode goes to trendMode instead.  Null outputs are not computed.
+ * begin[k] must not be less than the lookback of k.
+ */
+template <typename I, typename T>
+struct Hilbert {
+    I in;
+    TA_Integer n, start;
+    T *const *out;
+    TA_Integer *trendMode;
+    const TA_Integer *begin;
+
+    Hilbert (I _in, TA_Integer _n, TA_Integer _start, T *const *_out, TA_Integer *_trendMode,
+             const TA_Integer *_begin)
+        : in(_in), n(_n), start(_start), out(_out), trendMode(_trendMode), begin(_begin) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        unsigned mask = trendMode ? TAPP_HILBERT(HILBERT_TRENDMODE) : 0;
+        for (int k = 0; k < HILBERT_TRENDMODE; ++k) {
+            if (out[k]) mask |= TAPP_HILBERT(k);
+        }
+        HilbertState state(start, mask);
+        for (TA_Integer i = 0; i < n; ++i) {
+            state.push(in[i]);
+            for (int k = 0; k < HILBERT_TRENDMODE; ++k) {
+                if (out[k] && i >= begin[k]) out[k][i - begin[k]] = T(state.get(HilbertOutput(k)));
+            }
+            if (trendMode && i >= begin[HILBERT_TRENDMODE]) trendMode[i - begin[HILBERT_TRENDMODE]] = state.getTrendMode();
+        }
+    }
+};
+
+/// Hilbert transform indicators, see Hilbert.
+template <typename I, typename T>
+void hilbert (I in, TA_Integer n, TA_Integer start, T *const *out, TA_Integer *trendMode, const TA_Integer *begin)
+{
+    dispatch(Hilbert<I, T>(in, n, start, out, trendMode, begin));
+}
+
+template <typename T>
+bool callHilbert (const NativeCall<T> &call, TA_Integer start, HilbertOutput first, HilbertOutput second)
+{
+    T *out[HILBERT_OUTPUTS] = {0};
+    TA_Integer begin[HILBERT_OUTPUTS] = {0};
+    out[first] = call.out[0];
+    begin[first] = call.lookback;
+    if (second != first) {
+        out[second] = call.out[1];
+        begin[second] = call.lookback;
+    }
+    hilbert(call.real[0], call.size, start, out, (TA_Integer *)0, begin);
+    return true;
+}
+
+template <typename T>
+bool callHT_DCPERIOD (const NativeCall<T> &call)
+{
+    return callHilbert(call, HILBERT_PERIOD_START, HILBERT_DCPERIOD, HILBERT_DCPERIOD);
+}
+
+template <typename T>
+bool callHT_DCPHASE (const NativeCall<T> &call)
+{
+    return callHilbert(call, HILBERT_PHASE_START, HILBERT_DCPHASE, HILBERT_DCPHASE);
+}
+
+template <typename T>
+bool callHT_PHASOR (const NativeCall<T> &call)
+{
+    return callHilbert(call, HILBERT_PERIOD_START, HILBERT_INPHASE, HILBERT_QUADRATURE);
+}
+
+template <typename T>
+bool callHT_SINE (const NativeCall<T> &call)
+{
+    return callHilbert(call, HILBERT_PHASE_START, HILBERT_SINE, HILBERT_LEADSINE);
+}
+
+template <typename T>
+bool callHT_TRENDLINE (const NativeCall<T> &call)
+{
+    return callHilbert(call, HILBERT_PHASE_START, HILBERT_TRENDLINE, HILBERT_TRENDLINE);
+}
+
+template <typename T>
+bool callHT_TRENDMODE (const NativeCall<T> &call)
+{
+    T *out[HILBERT_OUTPUTS] = {0};
+    TA_Integer begin[HILBERT_OUTPUTS] = {0};
+    begin[HILBERT_TRENDMODE] = call.lookback;
+    hilbert(call.real[0], call.size, HILBERT_PHASE_START, out, call.outInteger[0], begin);
+    return true;
+}
+
+}
+
+/// Hilbert transform indicators in at most two passes.
+/**
+ * Computes the outputs of mask, a combination of TAPP_HILBERT bits, and
+ * returns all HILBERT_OUTPUTS series indexed by HilbertOutput, those not
+ * in mask empty.  Each series is the same as the output of TA with the
+ * corresponding function, including the unstable period.  The trend mode
+ * is 1 or 0.  As TA-lib starts HT_DCPERIOD and HT_PHASOR earlier than the
+ * others, their outputs take a pass of their own.
+ */
+template <typename S>
+std::vector<Series<typename Operand<S>::value_type> > hilbert (const S &input, unsigned mask = ~0u)
+{
+    typedef typename Operand<S>::value_type T;
+    const TA_Integer lookback[HILBERT_OUTPUTS] = {
+        TA_HT_DCPERIOD_Lookback(), TA_HT_DCPHASE_Lookback(), TA_HT_PHASOR_Lookback(), TA_HT_PHASOR_Lookback(),
+        TA_HT_SINE_Lookback(), TA_HT_SINE_Lookback(), TA_HT_TRENDLINE_Lookback(), TA_HT_TRENDMODE_Lookback()
+    };
+    const unsigned early = TAPP_HILBERT(HILBERT_DCPERIOD) | TAPP_HILBERT(HILBERT_INPHASE) | TAPP_HILBERT(HILBERT_QUADRATURE);
+    std::vector<Series<T> > r(HILBERT_OUTPUTS);
+    TA_Integer n = TA_Integer(input.size()) - input.getFirst();
+    std::vector<TA_Integer> mode;
+    for (int pass = 0; pass < 2; ++pass) {
+        T *out[HILBERT_OUTPUTS] = {0};
+        TA_Integer *trendMode = 0;
+        bool any = false;
+        for (int k = 0; k < HILBERT_OUTPUTS; ++k) {
+            if (!(mask & TAPP_HILBERT(k)) || bool(early & TAPP_HILBERT(k)) != (pass == 0)) continue;
+            if (native::prepareOutput(input, lookback[k], r[k]) == 0) continue;
+            if (k == HILBERT_TRENDMODE) {
+                mode.resize(n - lookback[k]);
+                trendMode = &mode[0];
+            }
+            else out[k] = &r[k][r[k].getFirst()];
+            any = true;
+        }
+        if (!any) continue;
+        native::hilbert(native::elements(input), n, pass == 0 ? HILBERT_PERIOD_START : HILBERT_PHASE_START,
+                        out, trendMode, lookback);
+    }
+    for (TA_Integer i = 0; i < TA_Integer(mode.size()); ++i) r[HILBERT_TRENDMODE][r[HILBERT_TRENDMODE].getFirst() + i] = T(mode[i]);
+    return r;
+}
+
+}
+
+#endif
@@ -0,0 +1,380 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_EXPR
+#define WDONG_TAPP_EXPR
+
+/**
+ * \file ta++-expr.h
+ * \brief Elementwise arithmetic on series.
+ *
+ * Arithmetic on Series is implemented with expression templates.  An
+ * expression like
+ *
+ *      RealSeries spread = candles.getClose() - ema[0].real;
+ *
+ * does not create any temporary series.  The operators only build a
+ * lightweight expression object, which is evaluated element by element in a
+ * single loop when it is assigned to a Series.  The loop contains no function
+ * calls, so the compiler is free to vectorize the whole formula.
+ *
+ * The first property of an expression is the maximum of those of its
+ * operands, and its size is the minimum of their sizes.  Entries before
+ * first are not computed.
+ *
+ * Supported operations are +, -, *, /, unary -, the comparisons <, >, <=,
+ * >=, eq and ne (which produce 1 or 0 of the value type), min, max, abs and
+ * log.  The operators == and != are not elementwise: they keep comparing
+ * whole series as std::vector does.  cast converts
+ * the value type, e.g. to compute in float, see ta++-float.h.  Either side of
+ * a binary operator may also be a scalar.
+ *
+ * The evaluation loop is a native kernel and runs with the best instruction
+ * set available, see ta++-cpu.h.
+ *
+ * The native series functions, such as sma() or rsi(), also take an
+ * expression, which their kernel evaluates as it reads it, so that e.g.
+ * sma(price<PRICE_TYPICAL>(candles), 20) allocates no intermediate series.
+ *
+ * This file is included by ta++.h and should not be included directly.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tapp {
+
+/// Value type of mixed series arithmetic.
+template <typename A, typename B> struct Promote { typedef A type; };
+template <> struct Promote<TA_Integer, TA_Real> { typedef TA_Real type; };
+template <> struct Promote<TA_Integer, float> { typedef float type; };
+template <> struct Promote<float, TA_Real> { typedef TA_Real type; };
+
+/// A lazily evaluated series expression.
+/**
+ * Expr wraps one of the expression nodes in namespace expr.  It behaves like
+ * a read-only series: it has operator [], size() and getFirst(), but nothing
+ * is computed until it is assigned to a Series.
+ */
+template <typename E>
+class Expr
+{
+    E e;
+public:
+    typedef typename E::value_type value_type;
+
+    explicit Expr (const E &_e): e(_e) {
+    }
+
+    value_type operator [] (size_t i) const {
+        return e[i];
+    }
+
+    size_t size () const {
+        return e.size();
+    }
+
+    TA_Integer getFirst () const {
+        return e.getFirst();
+    }
+
+    const E &get () const {
+        return e;
+    }
+
+    /// Evaluate the expression into a series.
+    template <typename T>
+    void assignTo (Series<T> &out) const {
+        size_t n = size();
+        size_t first = getFirst();
+        out.resize(n);
+        out.setFirst(first);
+        if (n <= first) return;
+        dispatch(Evaluate<T>(e, &out[0], first, n));
+    }
+
+private:
+    template <typename T>
+    struct Evaluate {
+        const E &e;
+        T *out;
+        size_t begin, end;
+
+        Evaluate (const E &_e, T *_out, size_t _begin, size_t _end)
+            : e(_e), out(_out), begin(_begin), end(_end) {
+        }
+
+        TAPP_INLINE void operator () () const {
+            E local(e);
+            T *o = out;
+            for (size_t i = begin; i < end; ++i) {
+                o[i] = T(local[i]);
+            }
+        }
+    };
+};
+
+/// Expression nodes.
+namespace expr {
+
+/// A series as an expression operand.
+template <typename T>
+class Terminal
+{
+    const T *data;
+    size_t n;
+    TA_Integer first;
+public:
+    typedef T value_type;
+
+    Terminal (const Series<T> &s)
+        : data(s.empty() ? 0 : &s[0]), n(s.size()), first(s.getFirst()) {
+    }
+    T operator [] (size_t i) const {
+        return data[i];
+    }
+    size_t size () const {
+        return n;
+    }
+    TA_Integer getFirst () const {
+        return first;
+    }
+};
+
+/// A scalar as an expression operand.
+template <typename T>
+class Constant
+{
+    T value;
+public:
+    typedef T value_type;
+
+    Constant (T v): value(v) {
+    }
+    T operator [] (size_t) const {
+        return value;
+    }
+    size_t size () const {
+        return std::numeric_limits<size_t>::max();
+    }
+    TA_Integer getFirst () const {
+        return 0;
+    }
+};
+
+template <typename Op, typename A>
+class Unary
+{
+    A a;
+public:
+    typedef typename A::value_type value_type;
+
+    Unary (const A &_a): a(_a) {
+    }
+    value_type operator [] (size_t i) const {
+        return Op::apply(a[i]);
+    }
+    size_t size () const {
+        return a.size();
+    }
+    TA_Integer getFirst () const {
+        return a.getFirst();
+    }
+};
+
+template <typename Op, typename L, typename R>
+class Binary
+{
+    L l;
+    R r;
+public:
+    typedef typename Promote<typename L::value_type, typename R::value_type>::type value_type;
+
+    Binary (const L &_l, const R &_r): l(_l), r(_r) {
+    }
+    value_type operator [] (size_t i) const {
+        return Op::apply(value_type(l[i]), value_type(r[i]));
+    }
+    size_t size () const {
+        return std::min(l.size(), r.size());
+    }
+    TA_Integer getFirst () const {
+        return std::max(l.getFirst(), r.getFirst());
+    }
+};
+
+struct Add { template <typename T> static T apply (T a, T b) { return a + b; } };
+struct Sub { template <typename T> static T apply (T a, T b) { return a - b; } };
+struct Mul { template <typename T> static T apply (T a, T b) { return a * b; } };
+struct Div { template <typename T> static T apply (T a, T b) { return a / b; } };
+struct Less { template <typename T> static T apply (T a, T b) { return a < b ? T(1) : T(0); } };
+struct Greater { template <typename T> static T apply (T a, T b) { return a > b ? T(1) : T(0); } };
+struct LessEqual { template <typename T> static T apply (T a, T b) { return a <= b ? T(1) : T(0); } };
+struct GreaterEqual { template <typename T> static T apply (T a, T b) { return a >= b ? T(1) : T(0); } };
+struct Equal { template <typename T> static T apply (T a, T b) { return a == b ? T(1) : T(0); } };
+struct NotEqual { template <typename T> static T apply (T a, T b) { return a != b ? T(1) : T(0); } };
+struct Min { template <typename T> static T apply (T a, T b) { return b < a ? b : a; } };
+struct Max { template <typename T> static T apply (T a, T b) { return a < b ? b : a; } };
+
+template <typename T, typename A>
+class Cast
+{
+    A a;
+public:
+    typedef T value_type;
+
+    Cast (const A &_a): a(_a) {
+    }
+    T operator [] (size_t i) const {
+        return T(a[i]);
+    }
+    size_t size () const {
+        return a.size();
+    }
+    TA_Integer getFirst () const {
+        return a.getFirst();
+    }
+};
+
+struct Neg { template <typename T> static T apply (T a) { return -a; } };
+struct Abs { template <typename T> static T apply (T a) { return a < T(0) ? -a : a; } };
+struct Log { template <typename T> static T apply (T a) { return std::log(a); } };
+
+}
+
+/// Maps the types that may appear in an expression to expression nodes.
+/**
+ * Only Series and Expr are operands; for any other type Operand has no
+ * members, which removes the operators below from overload resolution.
+ */
+template <typename X> struct Operand {};
+
+template <typename T>
+struct Operand<Series<T> > {
+    typedef expr::Terminal<T> type;
+    typedef T value_type;
+    static type make (const Series<T> &s) {
+        return type(s);
+    }
+};
+
+template <typename E>
+struct Operand<Expr<E> > {
+    typedef E type;
+    typedef typename E::value_type value_type;
+    static const E &make (const Expr<E> &e) {
+        return e.get();
+    }
+};
+
+#define TAPP_EXPR_BINARY(_func, _op) \
+template <typename L, typename R> \
+inline Expr<expr::Binary<expr::_op, typename Operand<L>::type, typename Operand<R>::type> > \
+_func (const L &l, const R &r) \
+{ \
+    typedef expr::Binary<expr::_op, typename Operand<L>::type, typename Operand<R>::type> node; \
+    return Expr<node>(node(Operand<L>::make(l), Operand<R>::make(r))); \
+} \
+template <typename L> \
+inline Expr<expr::Binary<expr::_op, typename Operand<L>::type, expr::Constant<typename Operand<L>::value_type> > > \
+_func (const L &l, typename Operand<L>::value_type r) \
+{ \
+    typedef expr::Constant<typename Operand<L>::value_type> constant; \
+    typedef expr::Binary<expr::_op, typename Operand<L>::type, constant> node; \
+    return Expr<node>(node(Operand<L>::make(l), constant(r))); \
+} \
+template <typename R> \
+inline Expr<expr::Binary<expr::_op, expr::Constant<typename Operand<R>::value_type>, typename Operand<R>::type> > \
+_func (typename Operand<R>::value_type l, const R &r) \
+{ \
+    typedef expr::Constant<typename Operand<R>::value_type> constant; \
+    typedef expr::Binary<expr::_op, constant, typename Operand<R>::type> node; \
+    return Expr<node>(node(constant(l), Operand<R>::make(r))); \
+}
+
+#define TAPP_EXPR_UNARY(_func, _op) \
+template <typename A> \
+inline Expr<expr::Unary<expr::_op, typename Operand<A>::type> > \
+_func (const A &a) \
+{ \
+    typedef expr::Unary<expr::_op, typename Operand<A>::type> node; \
+    return Expr<node>(node(Operand<A>::make(a))); \
+}
+
+TAPP_EXPR_BINARY(operator +, Add)
+TAPP_EXPR_BINARY(operator -, Sub)
+TAPP_EXPR_BINARY(operator *, Mul)
+TAPP_EXPR_BINARY(operator /, Div)
+TAPP_EXPR_BINARY(operator <, Less)
+TAPP_EXPR_BINARY(operator >, Greater)
+TAPP_EXPR_BINARY(operator <=, LessEqual)
+TAPP_EXPR_BINARY(operator >=, GreaterEqual)
+// == and != stay the whole-series comparison that Series inherits from
+// std::vector; elementwise equality is spelled eq and ne.
+TAPP_EXPR_BINARY(eq, Equal)
+TAPP_EXPR_BINARY(ne, NotEqual)
+TAPP_EXPR_BINARY(min, Min)
+TAPP_EXPR_BINARY(max, Max)
+
+// Two operands of the same type would otherwise pick std::min and std::max
+// when namespace std is also in use.
+#define TAPP_EXPR_SAME(_func, _op) \
+template <typename T> \
+inline Expr<expr::Binary<expr::_op, expr::Terminal<T>, expr::Terminal<T> > > \
+_func (const Series<T> &l, const Series<T> &r) \
+{ \
+    typedef expr::Binary<expr::_op, expr::Terminal<T>, expr::Terminal<T> > node; \
+    return Expr<node>(node(l, r)); \
+} \
+template <typename E> \
+inline Expr<expr::Binary<expr::_op, E, E> > \
+_func (const Expr<E> &l, const Expr<E> &r) \
+{ \
+    typedef expr::Binary<expr::_op, E, E> node; \
+    return Expr<node>(node(l.get(), r.get())); \
+}
+
+TAPP_EXPR_SAME(min, Min)
+TAPP_EXPR_SAME(max, Max)
+
+TAPP_EXPR_UNARY(operator -, Neg)
+TAPP_EXPR_UNARY(abs, Abs)
+TAPP_EXPR_UNARY(log, Log)
+
+/// Convert the value type of a series or expression.
+/**
+ * For example, cast<float>(candles.getClose()) gives the close prices in
+ * single precision.
+ */
+template <typename T, typename A>
+inline Expr<expr::Cast<T, typename Operand<A>::type> > cast (const A &a)
+{
+    typedef expr::Cast<T, typename Operand<A>::type> node;
+    return Expr<node>(node(Operand<A>::make(a)));
+}
+
+#undef TAPP_EXPR_BINARY
+#undef TAPP_EXPR_UNARY
+#undef TAPP_EXPR_SAME
+
+}
+
+#endif
+
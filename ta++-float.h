@@ -0,0 +1,265 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_FLOAT
+#define WDONG_TAPP_FLOAT
+
+/**
+ * \file ta++-float.h
+ * \brief Single precision compute mode.
+ *
+ * Broad screens rarely need double precision, and float storage halves the
+ * memory traffic and doubles the number of SIMD lanes.  The float mode
+ * consists of
+ * <ul>
+ * <li> FloatSeries, i.e. Series<float>.  cast<float>(series) converts an
+ * existing series, and all series arithmetic of ta++-expr.h works on it.
+ * </li>
+ * <li> FloatTA, the TA indicator with FloatSeries outputs.  It takes real
+ * inputs of either precision.
+ * </li>
+ * <li> validateFloat(), which reports how far the float results are from
+ * TA-lib's double results.
+ * </li>
+ * </ul>
+ *
+ * Candles are stored in double only.  On every call on candles, FloatTA
+ * converts the price columns the function reads, and only those, to float
+ * buffers for the native kernel.  That reads the doubles and writes the
+ * floats, so on candles the float mode moves more memory than the double
+ * mode, not less; it saves bandwidth only on FloatSeries inputs.  Where
+ * that matters, convert the columns once with cast<float>() and use the
+ * functions on series.
+ *
+ * \section float_bounds Error bounds
+ *
+ * Let u = 2^-24 (about 6e-8) be the unit roundoff of float.
+ * <ul>
+ * <li> Converting a double to float has a relative error of at most u.
+ * </li>
+ * <li> Each elementwise +, -, * and / in float adds a relative error of at
+ * most u to its result.  A formula of k operations on float inputs is
+ * therefore within about (k + 1) u of the exact result, unless it subtracts
+ * nearly equal values: the absolute error of a - b is at most (|a| + |b|) u,
+ * which can be large relative to a small difference such as close - EMA.
+ * </li>
+ * <li> FloatTA falls back to TA-lib for functions without a native float
+ * kernel.  TA-lib then computes in double on the converted inputs, so the
+ * only errors are the rounding of the inputs, amplified by the sensitivity
+ * of the function to its inputs, plus u for storing each output.
+ * </li>
+ * <li> Native float kernels compute pointwise stages in float but keep
+ * running sums and recursive states (moving sums, EMA and Wilder states) in
+ * double, so their error does not grow with the length of the series.
+ * </li>
+ * </ul>
+ * Functions with thresholds, like the candlestick patterns or the indices
+ * returned by MAXINDEX, can change their integer results when an input is
+ * rounded across a threshold.  Use validateFloat() on representative data to
+ * decide which precision a screen needs.
+ *
+ * This file is included by ta++.h and should not be included directly.
+ */
+
+#include <cmath>
+#include <ostream>
+
+namespace tapp {
+
+/// Deviation of a series from a reference series.
+struct Deviation {
+    /// Maximum absolute deviation.
+    TA_Real absolute;
+    /// Maximum deviation relative to the magnitude of the reference.
+    /** Entries where the reference is zero are not counted. */
+    TA_Real relative;
+    /// Index of the maximum absolute deviation, -1 if nothing was compared.
+    TA_Integer index;
+
+    Deviation (): absolute(0), relative(0), index(-1) {
+    }
+};
+
+/// Compute the deviation of a series from a reference.
+/**
+ * Only the entries valid in both series are compared.
+ */
+template <typename A, typename B>
+Deviation deviation (const Series<A> &reference, const Series<B> &series)
+{
+    Deviation d;
+    size_t first = std::max(reference.getFirst(), series.getFirst());
+    size_t n = std::min(reference.size(), series.size());
+    for (size_t i = first; i < n; ++i) {
+        TA_Real r = reference[i];
+        TA_Real diff = std::fabs(TA_Real(series[i]) - r);
+        if (d.index < 0 || diff > d.absolute) {
+            d.absolute = diff;
+            d.index = i;
+        }
+        if (r != 0 && diff / std::fabs(r) > d.relative) {
+            d.relative = diff / std::fabs(r);
+        }
+    }
+    return d;
+}
+
+namespace detail {
+
+static inline FloatSeries floatInput (const RealSeries &input) {
+    return cast<float>(input);
+}
+
+static inline Candles floatInput (const Candles &input) {
+    Candles r;
+    for (size_t i = 0; i < input.size(); ++i) {
+        r.push_back(Candle(float(input.getOpen()[i]), float(input.getHigh()[i]),
+                    float(input.getLow()[i]), float(input.getClose()[i]),
+                    float(input.getVolume()[i]), float(input.getOpenInterest()[i]),
+                    input.getTime()[i]));
+    }
+    r.setFirst(input.getFirst());
+    r.setFlags(input.getFlags());
+    return r;
+}
+
+template <typename A, typename B>
+std::vector<Deviation> compareOutputs (const BasicTA<A> &reference, const BasicTA<B> &ta)
+{
+    std::vector<Deviation> r;
+    for (unsigned i = 0; i < reference.getOutputs().size(); ++i) {
+        if (reference[i].type == TA_Output_Real) {
+            r.push_back(deviation(reference[i].real, ta[i].real));
+        }
+        else {
+            r.push_back(deviation(reference[i].integer, ta[i].integer));
+        }
+    }
+    return r;
+}
+
+}
+
+/// Validate a function computed in float.
+/**
+ * The function is computed by TA-lib with double inputs, which is the
+ * reference, and by FloatTA with the real inputs converted to float.  The
+ * latter uses the native float kernel of the function if there is one.
+ * Returns the deviation of each output.
+ */
+template <typename I>
+std::vector<Deviation> validateFloat (const std::string &name, const I &input, const TA::Options &options = TA::Options())
+{
+    bool native = setNativeEnabled(false);
+    TA reference(name, input, options);
+    setNativeEnabled(native);
+    FloatTA single(name, detail::floatInput(input), options);
+    return detail::compareOutputs(reference, single);
+}
+
+/// Validate a function with two inputs computed in float.
+template <typename I1, typename I2>
+std::vector<Deviation> validateFloat (const std::string &name, const I1 &input1, const I2 &input2, const TA::Options &options = TA::Options())
+{
+    bool native = setNativeEnabled(false);
+    TA reference(name, input1, input2, options);
+    setNativeEnabled(native);
+    FloatTA single(name, detail::floatInput(input1), detail::floatInput(input2), options);
+    return detail::compareOutputs(reference, single);
+}
+
+namespace detail {
+
+static inline void collectFunction (const TA_FuncInfo *info, void *names) {
+    static_cast<std::vector<std::string> *>(names)->push_back(info->name);
+}
+
+static inline bool isPriceInput (const TA_FuncInfo *info, unsigned idx) {
+    const TA_InputParameterInfo *input;
+    if (TA_GetInputParameterInfo(info->handle, idx, &input) != TA_SUCCESS) panic();
+    return input->type == TA_Input_Price;
+}
+
+/// The second real input of a function run on candles.
+/**
+ * MAVP takes periods, which cycle through its default range of 2 to 30;
+ * the other functions take the open prices.
+ */
+static inline RealSeries secondInput (const std::string &name, const Candles &candles) {
+    if (name != "MAVP") return candles.getOpen();
+    RealSeries periods;
+    periods.resize(candles.size());
+    for (size_t i = 0; i < periods.size(); ++i) periods[i] = 2 + i % 29;
+    periods.setFirst(candles.getFirst());
+    return periods;
+}
+
+}
+
+/// Validate all TA-lib functions in float.
+/**
+ * Every function is run with its default options on the candles: price
+ * inputs get the candles and real inputs get the close prices, or the close
+ * and the open prices for the functions with two real inputs, except MAVP,
+ * whose periods cycle through its default range.  One line is
+ * printed for each output, with the maximum absolute and relative deviation
+ * from the double results.
+ *
+ * This is a template only so that the float kernels are compiled where it
+ * is used; C is Candles.
+ */
+template <typename C>
+void validateFloat (const C &candles, std::ostream &os)
+{
+    std::vector<std::string> names;
+    if (TA_ForEachFunc(detail::collectFunction, &names) != TA_SUCCESS) panic();
+    BOOST_FOREACH(const std::string &name, names) {
+        const TA_FuncHandle *handle;
+        const TA_FuncInfo *info;
+        if (TA_GetFuncHandle(name.c_str(), &handle) != TA_SUCCESS) panic();
+        if (TA_GetFuncInfo(handle, &info) != TA_SUCCESS) panic();
+
+        std::vector<Deviation> r;
+        if (info->nbInput == 1) {
+            if (detail::isPriceInput(info, 0)) r = validateFloat(name, candles);
+            else r = validateFloat(name, candles.getClose());
+        }
+        else if (info->nbInput == 2) {
+            bool p0 = detail::isPriceInput(info, 0);
+            bool p1 = detail::isPriceInput(info, 1);
+            if (p0 && p1) r = validateFloat(name, candles, candles);
+            else if (p0) r = validateFloat(name, candles, candles.getClose());
+            else if (p1) r = validateFloat(name, candles.getClose(), candles);
+            else r = validateFloat(name, candles.getClose(), detail::secondInput(name, candles));
+        }
+        else continue;
+
+        for (unsigned i = 0; i < r.size(); ++i) {
+            const TA_OutputParameterInfo *output;
+            if (TA_GetOutputParameterInfo(handle, i, &output) != TA_SUCCESS) panic();
+            os << name << '\t' << output->paramName
+               << '\t' << r[i].absolute << '\t' << r[i].relative << std::endl;
+        }
+    }
+}
+
+}
+
+#endif
+
@@ -0,0 +1,276 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_MATH
+#define WDONG_TAPP_MATH
+
+/**
+ * \file ta++-math.h
+ * \brief Native math operators.
+ *
+ * highest(), lowest() and extremes() are not run through dispatch(), nor
+ * are the kernels built on Extremum elsewhere: AROON, AROONOSC, MIDPOINT,
+ * MIDPRICE, WILLR and the stochastics.  The deque of Extremum is serial,
+ * every step depending on the previous one through data dependent
+ * branches, so it does not vectorize and an AVX build runs no faster than
+ * the scalar one.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+namespace tapp {
+
+namespace native {
+
+/// Highest value over a period and its index.
+/**
+ * Either output may be null.  The lookback is period - 1.
+ */
+template <typename I, typename T>
+void highest (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out, TA_Integer *outIndex)
+{
+    Extremum<true, I> extremum(in, period);
+    for (TA_Integer i = begin - period + 1; i < begin; ++i) extremum.push(i, i - period + 1);
+    for (TA_Integer i = begin; i < n; ++i) {
+        TA_Integer h = extremum.next(i, i - period + 1);
+        if (out) out[i - begin] = T(in[h]);
+        if (outIndex) outIndex[i - begin] = h;
+    }
+}
+
+/// Lowest value over a period and its index.
+/**
+ * Either output may be null.  The lookback is period - 1.
+ */
+template <typename I, typename T>
+void lowest (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out, TA_Integer *outIndex)
+{
+    Extremum<false, I> extremum(in, period);
+    for (TA_Integer i = begin - period + 1; i < begin; ++i) extremum.push(i, i - period + 1);
+    for (TA_Integer i = begin; i < n; ++i) {
+        TA_Integer l = extremum.next(i, i - period + 1);
+        if (out) out[i - begin] = T(in[l]);
+        if (outIndex) outIndex[i - begin] = l;
+    }
+}
+
+/// Lowest and highest values over a period and their indices in one pass.
+/**
+ * Any output may be null.  The lookback is period - 1.
+ */
+template <typename I, typename T>
+void extremes (I in, TA_Integer n, TA_Integer period, TA_Integer begin,
+               T *outLow, TA_Integer *outLowIndex, T *outHigh, TA_Integer *outHighIndex)
+{
+    Extremum<false, I> low(in, period);
+    Extremum<true, I> high(in, period);
+    for (TA_Integer i = begin - period + 1; i < begin; ++i) {
+        low.push(i, i - period + 1);
+        high.push(i, i - period + 1);
+    }
+    for (TA_Integer i = begin; i < n; ++i) {
+        TA_Integer l = low.next(i, i - period + 1);
+        TA_Integer h = high.next(i, i - period + 1);
+        if (outLow) outLow[i - begin] = T(in[l]);
+        if (outLowIndex) outLowIndex[i - begin] = l;
+        if (outHigh) outHigh[i - begin] = T(in[h]);
+        if (outHighIndex) outHighIndex[i - begin] = h;
+    }
+}
+
+/// Sum over a period kernel.
+/**
+ * The window sum slides as a running sum updated in blocks by Recurrence,
+ * as in the simple moving average, so the results are TA-lib's up to
+ * rounding.  The lookback is period - 1.
+ */
+template <typename I, typename T>
+struct Sum {
+    I in;
+    TA_Integer n, period, begin;
+    T *out;
+    Recurrence total;
+
+    Sum (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _begin, T *_out)
+        : in(_in), n(_n), period(_period), begin(_begin), out(_out), total(1, 1) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        double first = 0;
+        for (TA_Integer i = begin - period + 1; i <= begin; ++i) first += in[i];
+        out[0] = T(first);
+        total.run(WindowDelta<I>(in, period), begin + 1, n, first, begin, 1, out);
+    }
+};
+
+/// Sum over a period.
+template <typename I, typename T>
+void sum (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+    dispatch(Sum<I, T>(in, n, period, begin, out));
+}
+
+/// Elementwise operator kernel.
+/**
+ * Op is a binary operator of expressions, such as expr::Add, applied in
+ * double.  The loop has no dependencies between elements, so it
+ * vectorizes and runs at memory bandwidth.
+ */
+template <typename Op, typename I, typename J, typename T>
+struct Elementwise {
+    I a;
+    J b;
+    TA_Integer n, begin;
+    T *out;
+
+    Elementwise (I _a, J _b, TA_Integer _n, TA_Integer _begin, T *_out)
+        : a(_a), b(_b), n(_n), begin(_begin), out(_out) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        for (TA_Integer i = begin; i < n; ++i) out[i - begin] = T(Op::apply(double(a[i]), double(b[i])));
+    }
+};
+
+/// Elementwise operator of two inputs, e.g. TA-lib's ADD, SUB, MULT and DIV.
+template <typename Op, typename I, typename J, typename T>
+void elementwise (I a, J b, TA_Integer n, TA_Integer begin, T *out)
+{
+    dispatch(Elementwise<Op, I, J, T>(a, b, n, begin, out));
+}
+
+template <typename T>
+bool callMAX (const NativeCall<T> &call)
+{
+    highest(call.real[0], call.size, call.integer(0), call.lookback, call.out[0], (TA_Integer *)0);
+    return true;
+}
+
+template <typename T>
+bool callMAXINDEX (const NativeCall<T> &call)
+{
+    highest(call.real[0], call.size, call.integer(0), call.lookback, (T *)0, call.outInteger[0]);
+    return true;
+}
+
+template <typename T>
+bool callMIN (const NativeCall<T> &call)
+{
+    lowest(call.real[0], call.size, call.integer(0), call.lookback, call.out[0], (TA_Integer *)0);
+    return true;
+}
+
+template <typename T>
+bool callMININDEX (const NativeCall<T> &call)
+{
+    lowest(call.real[0], call.size, call.integer(0), call.lookback, (T *)0, call.outInteger[0]);
+    return true;
+}
+
+template <typename T>
+bool callMINMAX (const NativeCall<T> &call)
+{
+    extremes(call.real[0], call.size, call.integer(0), call.lookback,
+             call.out[0], (TA_Integer *)0, call.out[1], (TA_Integer *)0);
+    return true;
+}
+
+template <typename T>
+bool callMINMAXINDEX (const NativeCall<T> &call)
+{
+    extremes(call.real[0], call.size, call.integer(0), call.lookback,
+             (T *)0, call.outInteger[0], (T *)0, call.outInteger[1]);
+    return true;
+}
+
+template <typename T>
+bool callSUM (const NativeCall<T> &call)
+{
+    sum(call.real[0], call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callADD (const NativeCall<T> &call)
+{
+    elementwise<expr::Add>(call.real[0], call.real[1], call.size, call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callSUB (const NativeCall<T> &call)
+{
+    elementwise<expr::Sub>(call.real[0], call.real[1], call.size, call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callMULT (const NativeCall<T> &call)
+{
+    elementwise<expr::Mul>(call.real[0], call.real[1], call.size, call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callDIV (const NativeCall<T> &call)
+{
+    elementwise<expr::Div>(call.real[0], call.real[1], call.size, call.lookback, call.out[0]);
+    return true;
+}
+
+}
+
+/// Highest value over a period, the same as TA("MAX", input).
+template <typename S>
+Series<typename Operand<S>::value_type> highest (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period - 1, output) == 0) return output;
+    native::highest(native::elements(input), input.size() - input.getFirst(), period, period - 1, &output[output.getFirst()], (TA_Integer *)0);
+    return output;
+}
+
+/// Lowest value over a period, the same as TA("MIN", input).
+template <typename S>
+Series<typename Operand<S>::value_type> lowest (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period - 1, output) == 0) return output;
+    native::lowest(native::elements(input), input.size() - input.getFirst(), period, period - 1, &output[output.getFirst()], (TA_Integer *)0);
+    return output;
+}
+
+/// Sum over a period, the same as TA("SUM", input) up to rounding.
+template <typename S>
+Series<typename Operand<S>::value_type> sum (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period - 1, output) == 0) return output;
+    native::sum(native::elements(input), input.size() - input.getFirst(), period, period - 1, &output[output.getFirst()]);
+    return output;
+}
+
+}
+
+#endif
+
@@ -0,0 +1,1171 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_MOMENTUM
+#define WDONG_TAPP_MOMENTUM
+
+/**
+ * \file ta++-momentum.h
+ * \brief Native momentum indicators.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+namespace tapp {
+
+/// Indicators of the directional movement family, see directional().
+enum DirectionalIndicator {
+    DIRECTIONAL_PLUS_DM, DIRECTIONAL_MINUS_DM, DIRECTIONAL_PLUS_DI, DIRECTIONAL_MINUS_DI,
+    DIRECTIONAL_DX, DIRECTIONAL_ADX, DIRECTIONAL_ADXR, DIRECTIONAL_INDICATORS
+};
+
+/// Measures of the change of a series over a period, see changes().
+enum ChangeMeasure {
+    CHANGE_MOM, CHANGE_ROC, CHANGE_ROCP, CHANGE_ROCR, CHANGE_ROCR100, CHANGE_MEASURES
+};
+
+/// Indicators smoothing gains and losses, see strength().
+enum GainLossIndicator {
+    GAIN_LOSS_RSI, GAIN_LOSS_CMO, GAIN_LOSS_INDICATORS
+};
+
+namespace native {
+
+/// Relative strength index kernel.
+/**
+ * P is the period if it is known at compile time, or 0 if it is given at
+ * runtime.  The Wilder smoothing follows TA-lib step by step, so the
+ * results are the same.  The lookback is period, plus any unstable period.
+ */
+template <int P, typename I, typename T>
+struct Rsi {
+    I in;
+    TA_Integer n, runtimePeriod, begin;
+    T *out;
+
+    Rsi (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _begin, T *_out)
+        : in(_in), n(_n), runtimePeriod(_period), begin(_begin), out(_out) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        const TA_Integer period = P > 0 ? P : runtimePeriod;
+        double gain = 0, loss = 0;
+        for (TA_Integer i = 1; i <= period; ++i) {
+            double d = double(in[i]) - double(in[i - 1]);
+            if (d < 0) loss -= d;
+            else gain += d;
+        }
+        loss /= period;
+        gain /= period;
+        for (TA_Integer i = period; ; ) {
+            if (i >= begin) {
+                double sum = gain + loss;
+                out[i - begin] = T(isZero(sum) ? 0 : 100.0 * (gain / sum));
+            }
+            if (++i >= n) break;
+            double d = double(in[i]) - double(in[i - 1]);
+            loss *= period - 1;
+            gain *= period - 1;
+            if (d < 0) loss -= d;
+            else gain += d;
+            loss /= period;
+            gain /= period;
+        }
+    }
+};
+
+/// Relative strength index over a period fixed at compile time.
+template <int P, typename I, typename T>
+void rsi (I in, TA_Integer n, TA_Integer begin, T *out)
+{
+    dispatch(Rsi<P, I, T>(in, n, P, begin, out));
+}
+
+/// Relative strength index.
+template <typename I, typename T>
+void rsi (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+#define TAPP_CASE(_p) case _p: rsi<_p>(in, n, begin, out); return;
+    switch (period) {
+    TAPP_FIXED_PERIODS(TAPP_CASE)
+    default: dispatch(Rsi<0, I, T>(in, n, period, begin, out));
+    }
+#undef TAPP_CASE
+}
+
+/// Wilder averages of the gains and losses over one period.
+/**
+ * The changes of elements 1 to period are averaged, and each later change
+ * is smoothed in with weight 1 / period, step by step as TA-lib's RSI and
+ * CMO do.
+ */
+struct GainLoss {
+    TA_Integer period;
+    double gain, loss;
+
+    explicit GainLoss (TA_Integer _period = 14): period(_period), gain(0), loss(0) {
+    }
+
+    /// Add the change d of element i >= 1.
+    TAPP_INLINE void push (TA_Integer i, double d) {
+        if (i > period) smooth(d);
+        else {
+            if (d < 0) loss -= d;
+            else gain += d;
+            if (i == period) {
+                loss /= period;
+                gain /= period;
+            }
+        }
+    }
+
+    /// Add the change of an element after element period.
+    TAPP_INLINE void smooth (double d) {
+        loss *= period - 1;
+        gain *= period - 1;
+        if (d < 0) loss -= d;
+        else gain += d;
+        loss /= period;
+        gain /= period;
+    }
+
+    TAPP_INLINE double rsi () const {
+        double sum = gain + loss;
+        return isZero(sum) ? 0 : 100.0 * (gain / sum);
+    }
+
+    TAPP_INLINE double cmo () const {
+        double sum = gain + loss;
+        return isZero(sum) ? 0 : 100.0 * ((gain - loss) / sum);
+    }
+};
+
+/// Kernel of RSI and CMO over several periods.
+/**
+ * out and begin are indexed by j * GAIN_LOSS_INDICATORS + m for the j-th
+ * of count periods and GainLossIndicator m.  out[k] is null if indicator
+ * k is not wanted, and otherwise receives element i - begin[k] for every
+ * input element i >= begin[k], where begin[k] is at least the period,
+ * plus any unstable period.  Each change is computed once and smoothed
+ * into the averages of every period, whose dependency chains overlap.
+ * The results are the same as TA-lib's.
+ */
+template <typename I, typename T>
+struct Strength {
+    I in;
+    TA_Integer n;
+    const TA_Integer *periods;
+    TA_Integer count;
+    T *const *out;
+    const TA_Integer *begin;
+
+    Strength (I _in, TA_Integer _n, const TA_Integer *_periods, TA_Integer _count,
+              T *const *_out, const TA_Integer *_begin)
+        : in(_in), n(_n), periods(_periods), count(_count), out(_out), begin(_begin) {
+    }
+
+    TAPP_INLINE void write (TA_Integer i, TA_Integer j, const GainLoss &average) const {
+        T *const *o = out + j * GAIN_LOSS_INDICATORS;
+        const TA_Integer *b = begin + j * GAIN_LOSS_INDICATORS;
+        if (o[GAIN_LOSS_RSI] && i >= b[GAIN_LOSS_RSI]) o[GAIN_LOSS_RSI][i - b[GAIN_LOSS_RSI]] = T(average.rsi());
+        if (o[GAIN_LOSS_CMO] && i >= b[GAIN_LOSS_CMO]) o[GAIN_LOSS_CMO][i - b[GAIN_LOSS_CMO]] = T(average.cmo());
+    }
+
+    TAPP_INLINE void operator () () const {
+        std::vector<GainLoss> average;
+        TA_Integer longest = 0;
+        for (TA_Integer j = 0; j < count; ++j) {
+            average.push_back(GainLoss(periods[j]));
+            longest = std::max(longest, periods[j]);
+        }
+        TA_Integer i = 1;
+        for (; i < n && i <= longest; ++i) {
+            double d = double(in[i]) - double(in[i - 1]);
+            for (TA_Integer j = 0; j < count; ++j) {
+                average[j].push(i, d);
+                if (i >= periods[j]) write(i, j, average[j]);
+            }
+        }
+        // Every average is smoothing from here on.
+        for (; i < n; ++i) {
+            double d = double(in[i]) - double(in[i - 1]);
+            for (TA_Integer j = 0; j < count; ++j) {
+                average[j].smooth(d);
+                write(i, j, average[j]);
+            }
+        }
+    }
+};
+
+/// RSI and CMO over several periods, see Strength.
+template <typename I, typename T>
+void strength (I in, TA_Integer n, const TA_Integer *periods, TA_Integer count,
+               T *const *out, const TA_Integer *begin)
+{
+    dispatch(Strength<I, T>(in, n, periods, count, out, begin));
+}
+
+/// Change of x from the earlier element d, of measure M, as TA-lib computes it.
+template <int M>
+TAPP_INLINE double change (double x, double d)
+{
+    switch (M) {
+    case CHANGE_MOM: return x - d;
+    case CHANGE_ROC: return d != 0.0 ? (x / d - 1.0) * 100.0 : 0.0;
+    case CHANGE_ROCP: return d != 0.0 ? (x - d) / d : 0.0;
+    case CHANGE_ROCR: return d != 0.0 ? x / d : 0.0;
+    default: return d != 0.0 ? (x / d) * 100.0 : 0.0;
+    }
+}
+
+/// Elements the change kernel runs through for each output before the next.
+static const TA_Integer CHANGE_BLOCK = 1024;
+
+/// Kernel of the changes of several measures over several periods.
+/**
+ * out and begin are indexed by j * CHANGE_MEASURES + m for the j-th of
+ * count periods and ChangeMeasure m.  out[k] is null if change k is not
+ * wanted, and otherwise receives element i - begin[k] for every input
+ * element i >= begin[k], where begin[k] is at least the period.  The input
+ * is read once, CHANGE_BLOCK elements at a time, and every output wanted
+ * is filled over a block while it is in cache, with a loop free of
+ * dependencies the compiler vectorizes.  The results are the same as
+ * TA-lib's.
+ */
+template <typename I, typename T>
+struct Changes {
+    I in;
+    TA_Integer n;
+    const TA_Integer *periods;
+    TA_Integer count;
+    T *const *out;
+    const TA_Integer *begin;
+
+    Changes (I _in, TA_Integer _n, const TA_Integer *_periods, TA_Integer _count,
+             T *const *_out, const TA_Integer *_begin)
+        : in(_in), n(_n), periods(_periods), count(_count), out(_out), begin(_begin) {
+    }
+
+    template <int M>
+    TAPP_INLINE void run (TA_Integer from, TA_Integer to, TA_Integer period, TA_Integer b, T *o) const {
+        for (TA_Integer i = std::max(from, b); i < to; ++i) {
+            o[i - b] = T(change<M>(in[i], in[i - period]));
+        }
+    }
+
+    TAPP_INLINE void operator () () const {
+        for (TA_Integer from = 0; from < n; from += CHANGE_BLOCK) {
+            TA_Integer to = std::min(n, from + CHANGE_BLOCK);
+            for (TA_Integer j = 0; j < count; ++j) {
+                TA_Integer p = periods[j];
+                T *const *o = out + j * CHANGE_MEASURES;
+                const TA_Integer *b = begin + j * CHANGE_MEASURES;
+                if (o[CHANGE_MOM]) run<CHANGE_MOM>(from, to, p, b[CHANGE_MOM], o[CHANGE_MOM]);
+                if (o[CHANGE_ROC]) run<CHANGE_ROC>(from, to, p, b[CHANGE_ROC], o[CHANGE_ROC]);
+                if (o[CHANGE_ROCP]) run<CHANGE_ROCP>(from, to, p, b[CHANGE_ROCP], o[CHANGE_ROCP]);
+                if (o[CHANGE_ROCR]) run<CHANGE_ROCR>(from, to, p, b[CHANGE_ROCR], o[CHANGE_ROCR]);
+                if (o[CHANGE_ROCR100]) run<CHANGE_ROCR100>(from, to, p, b[CHANGE_ROCR100], o[CHANGE_ROCR100]);
+            }
+        }
+    }
+};
+
+/// Changes of several measures over several periods, see Changes.
+template <typename I, typename T>
+void changes (I in, TA_Integer n, const TA_Integer *periods, TA_Integer count,
+              T *const *out, const TA_Integer *begin)
+{
+    dispatch(Changes<I, T>(in, n, periods, count, out, begin));
+}
+
+/// Aroon indicator kernel.
+/**
+ * Either of the Aroon down and up lines and the oscillator may be null.
+ * AROON and AROONOSC both take the latest of equal extremes.  The lookback
+ * is period.
+ */
+template <typename I, typename T>
+void aroon (I high, I low, TA_Integer n, TA_Integer period, TA_Integer begin, T *down, T *up, T *osc)
+{
+    Extremum<true, I> highest(high, period + 1, true);
+    Extremum<false, I> lowest(low, period + 1, true);
+    const double factor = 100.0 / period;
+    for (TA_Integer i = begin - period; i < begin; ++i) {
+        highest.push(i, i - period);
+        lowest.push(i, i - period);
+    }
+    for (TA_Integer i = begin; i < n; ++i) {
+        TA_Integer h = highest.next(i, i - period);
+        TA_Integer l = lowest.next(i, i - period);
+        if (down) down[i - begin] = T(factor * (period - (i - l)));
+        if (up) up[i - begin] = T(factor * (period - (i - h)));
+        if (osc) osc[i - begin] = T(factor * (h - l));
+    }
+}
+
+/// Directional movement kernel.
+/**
+ * PLUS_DM, MINUS_DM, PLUS_DI, MINUS_DI, DX, ADX and ADXR all smooth the
+ * same directional movements and true range the Wilder way, so this kernel
+ * computes any subset of them in one pass.  out and begin are indexed by
+ * DirectionalIndicator.  out[k] is null if indicator k is not wanted, and
+ * otherwise receives element i - begin[k] for every input element
+ * i >= begin[k].  begin[k] must not be less than the lookback of k: period
+ * - 1 for the movements, period for the indicators and DX, 2 period - 1
+ * for ADX and 3 period - 2 for ADXR, plus any unstable period.  The period
+ * must be at least 2.  Every step follows TA-lib, so the results are the
+ * same.
+ */
+template <typename I, typename T>
+struct Directional {
+    I high, low, close;
+    TA_Integer n, period;
+    T *const *out;
+    const TA_Integer *begin;
+
+    Directional (I _high, I _low, I _close, TA_Integer _n, TA_Integer _period,
+                 T *const *_out, const TA_Integer *_begin)
+        : high(_high), low(_low), close(_close), n(_n), period(_period), out(_out), begin(_begin) {
+    }
+
+    TAPP_INLINE void store (int indicator, TA_Integer i, double value) const {
+        if (out[indicator] && i >= begin[indicator]) out[indicator][i - begin[indicator]] = T(value);
+    }
+
+    TAPP_INLINE void operator () () const {
+        // ADX of the last period - 1 elements, for ADXR.
+        std::vector<double> history(out[DIRECTIONAL_ADXR] ? period - 1 : 0);
+        double plusDM = 0, minusDM = 0, range = 0, dx = 0, sumDX = 0, adx = 0;
+        // PLUS_DM and MINUS_DM alone need neither the close nor the range.
+        const bool ranges = out[DIRECTIONAL_PLUS_DI] || out[DIRECTIONAL_MINUS_DI] || out[DIRECTIONAL_DX]
+            || out[DIRECTIONAL_ADX] || out[DIRECTIONAL_ADXR];
+        for (TA_Integer i = 1; i < n; ++i) {
+            double h = high[i], l = low[i];
+            double diffP = h - double(high[i - 1]);
+            double diffM = double(low[i - 1]) - l;
+            double tr = 0;
+            if (ranges) {
+                double c = close[i - 1];
+                tr = std::max(h - l, std::max(std::fabs(h - c), std::fabs(l - c)));
+            }
+            if (i >= period) {
+                plusDM -= plusDM / period;
+                minusDM -= minusDM / period;
+                range -= range / period;
+            }
+            if (diffM > 0 && diffP < diffM) minusDM += diffM;
+            else if (diffP > 0 && diffP > diffM) plusDM += diffP;
+            range += tr;
+            if (i < period - 1) continue;
+            store(DIRECTIONAL_PLUS_DM, i, plusDM);
+            store(DIRECTIONAL_MINUS_DM, i, minusDM);
+            if (i < period) continue;
+            double plusDI = 0, minusDI = 0;
+            bool valid = false;
+            if (!isZero(range)) {
+                plusDI = 100.0 * (plusDM / range);
+                minusDI = 100.0 * (minusDM / range);
+                double sum = plusDI + minusDI;
+                if (!isZero(sum)) {
+                    dx = 100.0 * (std::fabs(minusDI - plusDI) / sum);
+                    valid = true;
+                }
+            }
+            store(DIRECTIONAL_PLUS_DI, i, plusDI);
+            store(DIRECTIONAL_MINUS_DI, i, minusDI);
+            if (out[DIRECTIONAL_DX] && i >= begin[DIRECTIONAL_DX]) {
+                // DX repeats its last value where it is undefined, except
+                // at its first output.
+                if (!valid && i == begin[DIRECTIONAL_DX]) dx = 0;
+                out[DIRECTIONAL_DX][i - begin[DIRECTIONAL_DX]] = T(dx);
+            }
+            if (!out[DIRECTIONAL_ADX] && !out[DIRECTIONAL_ADXR]) continue;
+            if (i < 2 * period - 1) {
+                if (valid) sumDX += dx;
+                continue;
+            }
+            if (i == 2 * period - 1) {
+                if (valid) sumDX += dx;
+                adx = sumDX / period;
+            }
+            else if (valid) adx = ((adx * (period - 1)) + dx) / period;
+            store(DIRECTIONAL_ADX, i, adx);
+            if (!out[DIRECTIONAL_ADXR]) continue;
+            TA_Integer slot = i % (period - 1);
+            store(DIRECTIONAL_ADXR, i, (adx + history[slot]) / 2.0);
+            history[slot] = adx;
+        }
+    }
+};
+
+/// Directional movement indicators, see Directional.
+template <typename I, typename T>
+void directional (I high, I low, I close, TA_Integer n, TA_Integer period,
+                  T *const *out, const TA_Integer *begin)
+{
+    dispatch(Directional<I, T>(high, low, close, n, period, out, begin));
+}
+
+/// Raw stochastic %K as TA-lib computes it.
+static inline double rawStochastic (double close, double highest, double lowest) {
+    double diff = (highest - lowest) / 100.0;
+    return diff != 0.0 ? (close - lowest) / diff : 0;
+}
+
+/// Williams' %R as TA-lib computes it.
+static inline double williamsR (double close, double highest, double lowest) {
+    double diff = (highest - lowest) / (-100.0);
+    return diff != 0.0 ? (highest - close) / diff : 0;
+}
+
+/// Raw stochastic %K and Williams' %R kernel.
+/**
+ * TA-lib rescans the window of the highest high and the lowest low
+ * whenever one of them leaves it.  Both come from Extremum windows here,
+ * in amortized constant time per element.  Either output may be null.
+ * The lookback is period - 1.
+ */
+template <typename I, typename T>
+void stochasticRange (I high, I low, I close, TA_Integer n, TA_Integer period, TA_Integer begin,
+                      T *fastK, T *willR)
+{
+    Extremum<true, I> highest(high, period);
+    Extremum<false, I> lowest(low, period);
+    for (TA_Integer i = begin - period + 1; i < begin; ++i) {
+        highest.push(i, i - period + 1);
+        lowest.push(i, i - period + 1);
+    }
+    for (TA_Integer i = begin; i < n; ++i) {
+        double h = high[highest.next(i, i - period + 1)];
+        double l = low[lowest.next(i, i - period + 1)];
+        if (fastK) fastK[i - begin] = T(rawStochastic(close[i], h, l));
+        if (willR) willR[i - begin] = T(williamsR(close[i], h, l));
+    }
+}
+
+/// Stochastic %K and %D from raw %K.
+/**
+ * %K is the moving average of kType over the n elements of raw, and %D the
+ * moving average of dType over %K.  A kPeriod of 1 leaves raw %K as it is,
+ * as in STOCHF.  Outputs are written for every element j >= begin, where
+ * begin must not be less than the lookbacks of the two averages together.
+ * Returns false if a type has no native kernel.
+ */
+template <typename T>
+bool stochastic (const double *raw, TA_Integer n, TA_Integer kPeriod, TA_MAType kType,
+                 TA_Integer dPeriod, TA_MAType dType, TA_Integer begin, T *outK, T *outD)
+{
+    TA_Integer kLookback = TA_MA_Lookback(kPeriod, kType);
+    TA_Integer dLookback = TA_MA_Lookback(dPeriod, dType);
+    std::vector<double> k(n - kLookback), d(n - kLookback - dLookback);
+    if (!movingAverage(kType, raw, n, kPeriod, kLookback, &k[0])) return false;
+    if (!movingAverage(dType, &k[0], n - kLookback, dPeriod, dLookback, &d[0])) return false;
+    for (TA_Integer j = begin; j < n; ++j) {
+        outK[j - begin] = T(k[j - kLookback]);
+        outD[j - begin] = T(d[j - kLookback - dLookback]);
+    }
+    return true;
+}
+
+/// Stochastic oscillator kernel.
+/**
+ * The lookback is fastKPeriod - 1 plus the lookbacks of the two averages.
+ */
+template <typename I, typename T>
+bool stochastic (I high, I low, I close, TA_Integer n, TA_Integer fastKPeriod,
+                 TA_Integer kPeriod, TA_MAType kType, TA_Integer dPeriod, TA_MAType dType,
+                 TA_Integer begin, T *outK, T *outD)
+{
+    TA_Integer lookback = fastKPeriod - 1;
+    std::vector<double> raw(n - lookback);
+    stochasticRange(high, low, close, n, fastKPeriod, lookback, &raw[0], (double *)0);
+    return stochastic(&raw[0], n - lookback, kPeriod, kType, dPeriod, dType, begin - lookback, outK, outD);
+}
+
+/// Options of the MACD family.
+struct MacdOptions {
+    TA_Integer fastPeriod, slowPeriod, signalPeriod;
+    TA_MAType fastType, slowType, signalType;
+    /// Smoothing factors of fast and slow EMAs, 0 for 2 / (period + 1).
+    double fastK, slowK;
+
+    MacdOptions (TA_Integer fast = 12, TA_Integer slow = 26, TA_Integer signal = 9)
+        : fastPeriod(fast), slowPeriod(slow), signalPeriod(signal),
+        fastType(TA_MAType_EMA), slowType(TA_MAType_EMA), signalType(TA_MAType_EMA),
+        fastK(0), slowK(0) {
+    }
+};
+
+/// Moving average as TA-lib computes it inside an indicator.
+/**
+ * TA-lib starts the average just early enough for its first output to fall
+ * on input element largest, the largest lookback of the indicator's
+ * averages, which matters for the seed of an EMA.  out[j] is the average at
+ * input element largest + j.  k is the smoothing factor of an EMA, 0 for
+ * the default.  Returns false if the type has no native kernel.
+ */
+template <typename T>
+bool alignedAverage (TA_MAType type, const T *in, TA_Integer n, TA_Integer period, double k,
+                     TA_Integer largest, double *out)
+{
+    TA_Integer lookback = TA_MA_Lookback(period, type);
+    TA_Integer offset = largest - lookback;
+    if (type == TA_MAType_EMA && k != 0) {
+        ema(in + offset, n - offset, period, k, lookback, out);
+        return true;
+    }
+    return movingAverage(type, in + offset, n - offset, period, lookback, out);
+}
+
+/// MACD from its fast and slow averages.
+/**
+ * fast and slow are aligned, and the MACD line is their difference.  The
+ * signal line is a moving average of signalType over the line and the
+ * histogram is the line minus the signal.  With an EMA signal all three
+ * come out of one pass over the averages.  Outputs are written for every
+ * element j >= begin, where begin must not be less than the lookback of
+ * the signal average.  Returns false if the type has no native kernel.
+ */
+template <typename F, typename T>
+bool macdLines (F fast, F slow, TA_Integer n, TA_Integer signalPeriod, TA_MAType signalType,
+                TA_Integer begin, T *outMacd, T *outSignal, T *outHist)
+{
+    if (signalType == TA_MAType_EMA && defaultCompatibility()) {
+        const double k = 2.0 / (signalPeriod + 1);
+        double signal = 0;
+        for (TA_Integer j = 0; j < signalPeriod; ++j) signal += double(fast[j]) - double(slow[j]);
+        signal /= signalPeriod;
+        for (TA_Integer j = signalPeriod - 1; j < n; ++j) {
+            double line = double(fast[j]) - double(slow[j]);
+            if (j >= signalPeriod) signal = ((line - signal) * k) + signal;
+            if (j < begin) continue;
+            outMacd[j - begin] = T(line);
+            outSignal[j - begin] = T(signal);
+            outHist[j - begin] = T(line - signal);
+        }
+        return true;
+    }
+    std::vector<double> line(n), signal(n - begin);
+    for (TA_Integer j = 0; j < n; ++j) line[j] = double(fast[j]) - double(slow[j]);
+    if (!movingAverage(signalType, &line[0], n, signalPeriod, begin, &signal[0])) return false;
+    for (TA_Integer j = begin; j < n; ++j) {
+        outMacd[j - begin] = T(line[j]);
+        outSignal[j - begin] = T(signal[j - begin]);
+        outHist[j - begin] = T(line[j] - signal[j - begin]);
+    }
+    return true;
+}
+
+/// MACD kernel.
+/**
+ * The fast and slow averages are computed once, aligned as TA-lib does,
+ * and all three outputs come from them in one pass.  The lookback is the
+ * largest lookback of the fast and slow averages plus that of the signal.
+ */
+template <typename T>
+bool macd (const T *in, TA_Integer n, MacdOptions o, TA_Integer begin, T *outMacd, T *outSignal, T *outHist)
+{
+    if (o.slowPeriod < o.fastPeriod) {
+        std::swap(o.slowPeriod, o.fastPeriod);
+        std::swap(o.slowType, o.fastType);
+        std::swap(o.slowK, o.fastK);
+    }
+    TA_Integer largest = std::max(TA_MA_Lookback(o.fastPeriod, o.fastType),
+                                  TA_MA_Lookback(o.slowPeriod, o.slowType));
+    TA_Integer m = n - largest;
+    std::vector<double> fast(m), slow(m);
+    if (!alignedAverage(o.fastType, in, n, o.fastPeriod, o.fastK, largest, &fast[0])) return false;
+    if (!alignedAverage(o.slowType, in, n, o.slowPeriod, o.slowK, largest, &slow[0])) return false;
+    return macdLines(&fast[0], &slow[0], m, o.signalPeriod, o.signalType, begin - largest,
+                     outMacd, outSignal, outHist);
+}
+
+/// Absolute or percentage price oscillator kernel.
+/**
+ * The lookback is that of the slower average.
+ */
+template <typename T>
+bool priceOscillator (const T *in, TA_Integer n, TA_Integer fastPeriod, TA_Integer slowPeriod,
+                      TA_MAType type, bool percent, TA_Integer begin, T *out)
+{
+    if (slowPeriod < fastPeriod) std::swap(slowPeriod, fastPeriod);
+    TA_Integer largest = TA_MA_Lookback(slowPeriod, type);
+    TA_Integer m = n - largest;
+    std::vector<double> fast(m), slow(m);
+    if (!alignedAverage(type, in, n, fastPeriod, 0, largest, &fast[0])) return false;
+    if (!alignedAverage(type, in, n, slowPeriod, 0, largest, &slow[0])) return false;
+    for (TA_Integer i = begin; i < n; ++i) {
+        double f = fast[i - largest], s = slow[i - largest];
+        if (!percent) out[i - begin] = T(f - s);
+        else out[i - begin] = T(isZero(s) ? 0 : ((f - s) / s) * 100.0);
+    }
+    return true;
+}
+
+template <typename T>
+bool callMACD (const NativeCall<T> &call)
+{
+    if (!defaultCompatibility()) return false;
+    MacdOptions o(call.integer(0), call.integer(1), call.integer(2));
+    return macd(call.real[0], call.size, o, call.lookback, call.out[0], call.out[1], call.out[2]);
+}
+
+template <typename T>
+bool callMACDEXT (const NativeCall<T> &call)
+{
+    if (!defaultCompatibility()) return false;
+    MacdOptions o(call.integer(0), call.integer(2), call.integer(4));
+    o.fastType = TA_MAType(call.integer(1));
+    o.slowType = TA_MAType(call.integer(3));
+    o.signalType = TA_MAType(call.integer(5));
+    return macd(call.real[0], call.size, o, call.lookback, call.out[0], call.out[1], call.out[2]);
+}
+
+template <typename T>
+bool callMACDFIX (const NativeCall<T> &call)
+{
+    if (!defaultCompatibility()) return false;
+    // TA-lib's fixed smoothing factors, not those of the periods.
+    MacdOptions o(12, 26, call.integer(0));
+    o.fastK = 0.15;
+    o.slowK = 0.075;
+    return macd(call.real[0], call.size, o, call.lookback, call.out[0], call.out[1], call.out[2]);
+}
+
+template <typename T>
+bool callAPO (const NativeCall<T> &call)
+{
+    if (!defaultCompatibility()) return false;
+    return priceOscillator(call.real[0], call.size, call.integer(0), call.integer(1),
+                           TA_MAType(call.integer(2)), false, call.lookback, call.out[0]);
+}
+
+template <typename T>
+bool callPPO (const NativeCall<T> &call)
+{
+    if (!defaultCompatibility()) return false;
+    return priceOscillator(call.real[0], call.size, call.integer(0), call.integer(1),
+                           TA_MAType(call.integer(2)), true, call.lookback, call.out[0]);
+}
+
+template <typename T>
+bool callAROON (const NativeCall<T> &call)
+{
+    aroon(call.high, call.low, call.size, call.integer(0), call.lookback, call.out[0], call.out[1], (T *)0);
+    return true;
+}
+
+template <typename T>
+bool callAROONOSC (const NativeCall<T> &call)
+{
+    aroon(call.high, call.low, call.size, call.integer(0), call.lookback, (T *)0, (T *)0, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callDirectional (const NativeCall<T> &call, DirectionalIndicator indicator)
+{
+    // TA-lib has special cases for period 1.
+    if (call.integer(0) < 2) return false;
+    T *out[DIRECTIONAL_INDICATORS] = {0};
+    TA_Integer begin[DIRECTIONAL_INDICATORS] = {0};
+    out[indicator] = call.out[0];
+    begin[indicator] = call.lookback;
+    directional(call.high, call.low, call.close, call.size, call.integer(0), out, begin);
+    return true;
+}
+
+template <typename T>
+bool callADX (const NativeCall<T> &call)
+{
+    return callDirectional(call, DIRECTIONAL_ADX);
+}
+
+template <typename T>
+bool callADXR (const NativeCall<T> &call)
+{
+    return callDirectional(call, DIRECTIONAL_ADXR);
+}
+
+template <typename T>
+bool callDX (const NativeCall<T> &call)
+{
+    return callDirectional(call, DIRECTIONAL_DX);
+}
+
+template <typename T>
+bool callMINUS_DI (const NativeCall<T> &call)
+{
+    return callDirectional(call, DIRECTIONAL_MINUS_DI);
+}
+
+template <typename T>
+bool callMINUS_DM (const NativeCall<T> &call)
+{
+    return callDirectional(call, DIRECTIONAL_MINUS_DM);
+}
+
+template <typename T>
+bool callPLUS_DI (const NativeCall<T> &call)
+{
+    return callDirectional(call, DIRECTIONAL_PLUS_DI);
+}
+
+template <typename T>
+bool callPLUS_DM (const NativeCall<T> &call)
+{
+    return callDirectional(call, DIRECTIONAL_PLUS_DM);
+}
+
+template <typename T>
+bool callCMO (const NativeCall<T> &call)
+{
+    // TA-lib seeds CMO differently for Metastock.
+    if (!defaultCompatibility()) return false;
+    T *out[GAIN_LOSS_INDICATORS] = {0};
+    TA_Integer begin[GAIN_LOSS_INDICATORS] = {0};
+    TA_Integer period = call.integer(0);
+    out[GAIN_LOSS_CMO] = call.out[0];
+    begin[GAIN_LOSS_CMO] = call.lookback;
+    strength(call.real[0], call.size, &period, 1, out, begin);
+    return true;
+}
+
+template <typename T>
+bool callChange (const NativeCall<T> &call, ChangeMeasure measure)
+{
+    T *out[CHANGE_MEASURES] = {0};
+    TA_Integer begin[CHANGE_MEASURES] = {0};
+    TA_Integer period = call.integer(0);
+    out[measure] = call.out[0];
+    begin[measure] = call.lookback;
+    changes(call.real[0], call.size, &period, 1, out, begin);
+    return true;
+}
+
+template <typename T>
+bool callMOM (const NativeCall<T> &call)
+{
+    return callChange(call, CHANGE_MOM);
+}
+
+template <typename T>
+bool callROC (const NativeCall<T> &call)
+{
+    return callChange(call, CHANGE_ROC);
+}
+
+template <typename T>
+bool callROCP (const NativeCall<T> &call)
+{
+    return callChange(call, CHANGE_ROCP);
+}
+
+template <typename T>
+bool callROCR (const NativeCall<T> &call)
+{
+    return callChange(call, CHANGE_ROCR);
+}
+
+template <typename T>
+bool callROCR100 (const NativeCall<T> &call)
+{
+    return callChange(call, CHANGE_ROCR100);
+}
+
+template <typename T>
+bool callRSI (const NativeCall<T> &call)
+{
+    if (!defaultCompatibility()) return false;
+    rsi(call.real[0], call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callSTOCH (const NativeCall<T> &call)
+{
+    return stochastic(call.high, call.low, call.close, call.size, call.integer(0),
+                      call.integer(1), TA_MAType(call.integer(2)), call.integer(3), TA_MAType(call.integer(4)),
+                      call.lookback, call.out[0], call.out[1]);
+}
+
+template <typename T>
+bool callSTOCHF (const NativeCall<T> &call)
+{
+    return stochastic(call.high, call.low, call.close, call.size, call.integer(0),
+                      1, TA_MAType_SMA, call.integer(1), TA_MAType(call.integer(2)),
+                      call.lookback, call.out[0], call.out[1]);
+}
+
+template <typename T>
+bool callSTOCHRSI (const NativeCall<T> &call)
+{
+    if (!defaultCompatibility()) return false;
+    // As TA-lib, STOCHF over RSI as high, low and close.
+    TA_Integer rsiLookback = TA_RSI_Lookback(call.integer(0));
+    std::vector<double> r(call.size - rsiLookback);
+    rsi(call.real[0], call.size, call.integer(0), rsiLookback, &r[0]);
+    return stochastic(&r[0], &r[0], &r[0], call.size - rsiLookback, call.integer(1),
+                      1, TA_MAType_SMA, call.integer(2), TA_MAType(call.integer(3)),
+                      call.lookback - rsiLookback, call.out[0], call.out[1]);
+}
+
+template <typename T>
+bool callWILLR (const NativeCall<T> &call)
+{
+    stochasticRange(call.high, call.low, call.close, call.size, call.integer(0), call.lookback,
+                    (T *)0, call.out[0]);
+    return true;
+}
+
+}
+
+/// Outputs of MACD.
+template <typename T>
+struct MacdSeries {
+    Series<T> macd, signal, hist;
+};
+
+/// MACD from fast and slow averages computed elsewhere.
+/**
+ * The averages are reused rather than computed again, e.g. those of
+ * emaRibbon() or of TA("EMA"), and must be over the same input.  The
+ * MACD line is their difference, the signal a moving average of the line
+ * and the histogram the difference of the two, all computed in one pass.
+ *
+ * TA-lib seeds the fast EMA of MACD with the average of the elements just
+ * before the first output of the slow EMA, while a standalone EMA is
+ * seeded at the first elements.  The difference from TA("MACD") decays by
+ * a factor of 1 - 2 / (fast + 1) per element.
+ */
+template <typename T>
+MacdSeries<T> macd (const Series<T> &fastMA, const Series<T> &slowMA, TA_Integer signalPeriod = 9,
+                    TA_MAType signalType = TA_MAType_EMA)
+{
+    MacdSeries<T> r;
+    TA_Integer first = std::max(fastMA.getFirst(), slowMA.getFirst());
+    TA_Integer size = std::min(fastMA.size(), slowMA.size());
+    TA_Integer lookback = TA_MA_Lookback(signalPeriod, signalType);
+    Series<T> *outputs[] = {&r.macd, &r.signal, &r.hist};
+    for (unsigned i = 0; i < 3; ++i) {
+        outputs[i]->resize(size);
+        outputs[i]->setFirst(std::min(first + lookback, size));
+    }
+    if (size - first <= lookback) return r;
+    if (!native::macdLines(&fastMA[first], &slowMA[first], size - first, signalPeriod, signalType, lookback,
+                           &r.macd[first + lookback], &r.signal[first + lookback], &r.hist[first + lookback])) {
+        panic("moving average type %d has no native kernel\n", int(signalType));
+    }
+    return r;
+}
+
+/// Percentage price oscillator from fast and slow averages computed elsewhere.
+/**
+ * The absolute price oscillator needs no function: it is fastMA - slowMA.
+ */
+template <typename T>
+Series<T> ppo (const Series<T> &fastMA, const Series<T> &slowMA)
+{
+    Series<T> output;
+    TA_Integer first = std::max(fastMA.getFirst(), slowMA.getFirst());
+    TA_Integer size = std::min(fastMA.size(), slowMA.size());
+    output.resize(size);
+    output.setFirst(first);
+    for (TA_Integer i = first; i < size; ++i) {
+        double s = slowMA[i];
+        output[i] = T(native::isZero(s) ? 0 : ((fastMA[i] - s) / s) * 100.0);
+    }
+    return output;
+}
+
+/// Outputs of the stochastic oscillators.
+template <typename T>
+struct StochasticSeries {
+    Series<T> k, d;
+};
+
+/// Stochastic oscillator from the highest high and lowest low.
+/**
+ * highest and lowest are over the fast %K period, e.g.
+ * highest(candles.getHigh(), 5) and lowest(candles.getLow(), 5).  They
+ * are computed once and shared by several oscillators over the same
+ * candles: the result is TA("STOCH") with slow %K of kPeriod and kType and
+ * slow %D of dPeriod and dType, or TA("STOCHF") with fast %D of dPeriod
+ * and dType if kPeriod is 1, and williamsR() takes the same series.
+ */
+template <typename T>
+StochasticSeries<T> stochastic (const Series<T> &close, const Series<T> &highest, const Series<T> &lowest,
+                                TA_Integer kPeriod = 3, TA_MAType kType = TA_MAType_SMA,
+                                TA_Integer dPeriod = 3, TA_MAType dType = TA_MAType_SMA)
+{
+    StochasticSeries<T> r;
+    TA_Integer first = std::max(close.getFirst(), std::max(highest.getFirst(), lowest.getFirst()));
+    TA_Integer size = std::min(close.size(), std::min(highest.size(), lowest.size()));
+    TA_Integer lookback = TA_MA_Lookback(kPeriod, kType) + TA_MA_Lookback(dPeriod, dType);
+    r.k.resize(size);
+    r.k.setFirst(std::min(first + lookback, size));
+    r.d.resize(size);
+    r.d.setFirst(std::min(first + lookback, size));
+    if (size - first <= lookback) return r;
+    std::vector<double> raw(size - first);
+    for (TA_Integer i = first; i < size; ++i) raw[i - first] = native::rawStochastic(close[i], highest[i], lowest[i]);
+    if (!native::stochastic(&raw[0], size - first, kPeriod, kType, dPeriod, dType, lookback,
+                            &r.k[first + lookback], &r.d[first + lookback])) {
+        panic("moving average type %d or %d has no native kernel\n", int(kType), int(dType));
+    }
+    return r;
+}
+
+/// Williams' %R from the highest high and lowest low, see stochastic().
+template <typename T>
+Series<T> williamsR (const Series<T> &close, const Series<T> &highest, const Series<T> &lowest)
+{
+    Series<T> output;
+    TA_Integer first = std::max(close.getFirst(), std::max(highest.getFirst(), lowest.getFirst()));
+    TA_Integer size = std::min(close.size(), std::min(highest.size(), lowest.size()));
+    output.resize(size);
+    output.setFirst(first);
+    for (TA_Integer i = first; i < size; ++i) output[i] = T(native::williamsR(close[i], highest[i], lowest[i]));
+    return output;
+}
+
+/// Bit of a directional movement indicator in the mask of directional().
+#define TAPP_DIRECTIONAL(_indicator) (1u << (_indicator))
+
+/// Directional movement indicators in one pass over the candles.
+/**
+ * Computes the indicators of mask, a combination of TAPP_DIRECTIONAL bits,
+ * and returns all DIRECTIONAL_INDICATORS series indexed by
+ * DirectionalIndicator, those not in mask empty.  Each series is the same
+ * as TA of its indicator with optInTimePeriod period, including the
+ * unstable period, and a trend screen that needs several of them pays for
+ * the smoothing once.  For example,
+ *
+ * std::vector<RealSeries> dm = directional(candles, 14,
+ *         TAPP_DIRECTIONAL(DIRECTIONAL_ADX) | TAPP_DIRECTIONAL(DIRECTIONAL_PLUS_DI)
+ *         | TAPP_DIRECTIONAL(DIRECTIONAL_MINUS_DI));
+ *
+ * The period must be at least 2.
+ */
+static inline std::vector<RealSeries> directional (const Candles &candles, TA_Integer period = 14,
+                                                   unsigned mask = ~0u)
+{
+    verify(period > 1);
+    const TA_Integer lookback[DIRECTIONAL_INDICATORS] = {
+        TA_PLUS_DM_Lookback(period), TA_MINUS_DM_Lookback(period),
+        TA_PLUS_DI_Lookback(period), TA_MINUS_DI_Lookback(period),
+        TA_DX_Lookback(period), TA_ADX_Lookback(period), TA_ADXR_Lookback(period)
+    };
+    std::vector<RealSeries> r(DIRECTIONAL_INDICATORS);
+    TA_Real *out[DIRECTIONAL_INDICATORS] = {0};
+    TA_Integer begin[DIRECTIONAL_INDICATORS] = {0};
+    const RealSeries &close = candles.getClose();
+    TA_Integer first = close.getFirst();
+    TA_Integer n = TA_Integer(close.size()) - first;
+    bool any = false;
+    for (int k = 0; k < DIRECTIONAL_INDICATORS; ++k) {
+        if (!(mask & TAPP_DIRECTIONAL(k))) continue;
+        if (native::prepareOutput(close, lookback[k], r[k]) == 0) continue;
+        out[k] = &r[k][r[k].getFirst()];
+        begin[k] = lookback[k];
+        any = true;
+    }
+    if (!any) return r;
+    native::directional(&candles.getHigh()[first], &candles.getLow()[first], &close[first],
+                        n, period, out, begin);
+    return r;
+}
+
+/// Relative strength index over a period fixed at compile time.
+/**
+ * The same as TA("RSI", input) with optInTimePeriod P and no unstable
+ * period.
+ */
+template <int P, typename S>
+Series<typename Operand<S>::value_type> rsi (const S &input)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, P, output) == 0) return output;
+    native::rsi<P>(native::elements(input), input.size() - input.getFirst(), P, &output[output.getFirst()]);
+    return output;
+}
+
+/// Relative strength index.
+template <typename S>
+Series<typename Operand<S>::value_type> rsi (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period, output) == 0) return output;
+    native::rsi(native::elements(input), input.size() - input.getFirst(), period, period, &output[output.getFirst()]);
+    return output;
+}
+
+/// Chande momentum oscillator.
+/**
+ * The same as TA("CMO", input) with optInTimePeriod period and no
+ * unstable period.
+ */
+template <typename S>
+Series<typename Operand<S>::value_type> cmo (const S &input, TA_Integer period = 14)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period, output) == 0) return output;
+    T *out[GAIN_LOSS_INDICATORS] = {0};
+    TA_Integer begin[GAIN_LOSS_INDICATORS] = {period, period};
+    out[GAIN_LOSS_CMO] = &output[output.getFirst()];
+    native::strength(native::elements(input), input.size() - input.getFirst(), &period, 1, out, begin);
+    return output;
+}
+
+/// Bit of an indicator in the mask of strength().
+#define TAPP_GAIN_LOSS(_indicator) (1u << (_indicator))
+
+/// RSI and CMO over several periods in one pass.
+/**
+ * Computes the indicators of mask, a combination of TAPP_GAIN_LOSS bits,
+ * over each of periods, and returns periods.size() * GAIN_LOSS_INDICATORS
+ * series, the one of the j-th period and indicator m at
+ * j * GAIN_LOSS_INDICATORS + m and those not in mask empty.  Each series
+ * is the same as TA of its indicator with optInTimePeriod the period and
+ * no unstable period.  Periods must be at least 2.
+ */
+template <typename S>
+std::vector<Series<typename Operand<S>::value_type> > strength (const S &input, const std::vector<TA_Integer> &periods,
+                                                                unsigned mask = ~0u)
+{
+    typedef typename Operand<S>::value_type T;
+    TA_Integer count = TA_Integer(periods.size());
+    std::vector<Series<T> > r(count * GAIN_LOSS_INDICATORS);
+    std::vector<T *> out(r.size(), (T *)0);
+    std::vector<TA_Integer> begin(r.size(), 0);
+    bool any = false;
+    for (TA_Integer j = 0; j < count; ++j) {
+        verify(periods[j] > 1);
+        for (int m = 0; m < GAIN_LOSS_INDICATORS; ++m) {
+            TA_Integer k = j * GAIN_LOSS_INDICATORS + m;
+            if (!(mask & TAPP_GAIN_LOSS(m))) continue;
+            if (native::prepareOutput(input, periods[j], r[k]) == 0) continue;
+            out[k] = &r[k][r[k].getFirst()];
+            begin[k] = periods[j];
+            any = true;
+        }
+    }
+    if (!any) return r;
+    native::strength(native::elements(input), input.size() - input.getFirst(), &periods[0], count, &out[0], &begin[0]);
+    return r;
+}
+
+/// RSI and CMO of live values over several periods.
+/**
+ * This state takes one value at a time in constant time and memory per
+ * period.  Once period j is ready, its values are those of TA at the last
+ * value with optInTimePeriod the period, whatever the unstable period, as
+ * TA-lib's smoothing also starts at the first element.
+ */
+class GainLossState
+{
+    std::vector<native::GainLoss> average;
+    TA_Integer count;
+    double previous;
+public:
+    explicit GainLossState (TA_Integer period = 14): average(1, native::GainLoss(period)), count(0), previous(0) {
+    }
+
+    explicit GainLossState (const std::vector<TA_Integer> &periods): count(0), previous(0) {
+        for (size_t j = 0; j < periods.size(); ++j) average.push_back(native::GainLoss(periods[j]));
+    }
+
+    /// Add the next value.
+    void push (double value) {
+        if (count > 0) {
+            for (size_t j = 0; j < average.size(); ++j) average[j].push(count, value - previous);
+        }
+        previous = value;
+        ++count;
+    }
+
+    /// Number of values added.
+    TA_Integer size () const {
+        return count;
+    }
+
+    /// Check whether the j-th period is available, from value period on.
+    bool ready (size_t j = 0) const {
+        return count > average[j].period;
+    }
+
+    double getRSI (size_t j = 0) const {
+        return average[j].rsi();
+    }
+
+    double getCMO (size_t j = 0) const {
+        return average[j].cmo();
+    }
+};
+
+/// Bit of a measure of change in the mask of changes().
+#define TAPP_CHANGE(_measure) (1u << (_measure))
+
+/// Changes of several measures over several periods in one pass.
+/**
+ * Computes the measures of mask, a combination of TAPP_CHANGE bits, over
+ * each of periods, and returns periods.size() * CHANGE_MEASURES series,
+ * the one of the j-th period and measure m at j * CHANGE_MEASURES + m and
+ * those not in mask empty.  Each series is the same as TA of its measure
+ * with optInTimePeriod the period.  For example, the returns over a day,
+ * a week and a month,
+ *
+ * std::vector<RealSeries> r = changes(close, periods, TAPP_CHANGE(CHANGE_ROCP) | TAPP_CHANGE(CHANGE_MOM));
+ *
+ * with periods 1, 5 and 21.  Periods must be positive.
+ */
+template <typename S>
+std::vector<Series<typename Operand<S>::value_type> > changes (const S &input, const std::vector<TA_Integer> &periods,
+                                                               unsigned mask = ~0u)
+{
+    typedef typename Operand<S>::value_type T;
+    TA_Integer count = TA_Integer(periods.size());
+    std::vector<Series<T> > r(count * CHANGE_MEASURES);
+    std::vector<T *> out(r.size(), (T *)0);
+    std::vector<TA_Integer> begin(r.size(), 0);
+    bool any = false;
+    for (TA_Integer j = 0; j < count; ++j) {
+        verify(periods[j] > 0);
+        for (int m = 0; m < CHANGE_MEASURES; ++m) {
+            TA_Integer k = j * CHANGE_MEASURES + m;
+            if (!(mask & TAPP_CHANGE(m))) continue;
+            if (native::prepareOutput(input, periods[j], r[k]) == 0) continue;
+            out[k] = &r[k][r[k].getFirst()];
+            begin[k] = periods[j];
+            any = true;
+        }
+    }
+    if (!any) return r;
+    native::changes(native::elements(input), input.size() - input.getFirst(), &periods[0], count, &out[0], &begin[0]);
+    return r;
+}
+
+}
+
+#endif
+
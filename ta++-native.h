@@ -0,0 +1,354 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_NATIVE
+#define WDONG_TAPP_NATIVE
+
+/**
+ * \file ta++-native.h
+ * \brief Native implementations of TA functions.
+ *
+ * TA-lib is written for generality rather than speed.  For the functions
+ * used most, TA++ has its own kernels, which TA uses instead of TA-lib when
+ * their results match TA-lib's up to rounding.  A kernel that does not
+ * support some option, or the Metastock compatibility mode of TA-lib,
+ * declines the call and TA falls back to TA-lib.  setNativeEnabled(false)
+ * turns the native implementations off altogether.
+ *
+ * The kernels are organized like the groups of TA-lib, one file per group.
+ * Each file has three layers:
+ * <ul>
+ * <li> The kernels in namespace tapp::native.  A kernel reads n input
+ * elements through anything with operator [], usually a pointer, and
+ * computes from element 0.  It writes output element i - begin for every
+ * input element i >= begin, where begin must not be less than the kernel's
+ * lookback.  Hot loops that vectorize are kernel functors run through
+ * dispatch(), see ta++-cpu.h; the candlestick patterns and the sliding
+ * extrema of Extremum are serial and branchy and run as plain code.  Kernels are templates of the value type, so all of them
+ * work in float as well, see ta++-float.h.
+ * </li>
+ * <li> Functions on series in namespace tapp, for direct use.
+ * </li>
+ * <li> The adapters for TA, which are listed in TAPP_NATIVE_FUNCTIONS below.
+ * </li>
+ * </ul>
+ *
+ * The kernels take long to compile, since each is built for several
+ * instruction sets.  Only the precisions TA is used with are compiled, and
+ * defining TAPP_NO_NATIVE before including ta++.h keeps TA from using, and
+ * compiling, any of them; the series functions remain available.
+ *
+ * This file is included by ta++.h and should not be included directly.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+namespace tapp {
+
+namespace native {
+
+/// TA-lib's test for zero.
+static inline bool isZero (double v) {
+    return -0.00000001 < v && v < 0.00000001;
+}
+
+/// TA-lib's test for zero or negative.
+static inline bool isZeroOrNeg (double v) {
+    return v < 0.00000001;
+}
+
+/// Check whether TA-lib computes in its default compatibility mode.
+static inline bool defaultCompatibility () {
+    return TA_GetCompatibility() == TA_COMPATIBILITY_DEFAULT;
+}
+
+/// Prepare the output of a function on series.
+/**
+ * The output is sized like the input and its first is lookback entries
+ * after that of the input.  Returns the number of input elements from the
+ * input's first on, or 0 if they are too few for any output.
+ */
+template <typename T, typename S>
+TA_Integer prepareOutput (const S &input, TA_Integer lookback, Series<T> &output)
+{
+    TA_Integer n = TA_Integer(input.size()) - input.getFirst();
+    output.resize(input.size());
+    output.setFirst(input.getFirst() + lookback);
+    return n > lookback ? n : 0;
+}
+
+/// Elements of a series from its first on, the input of a kernel.
+template <typename T>
+const T *elements (const Series<T> &input)
+{
+    return &input[input.getFirst()];
+}
+
+/// Elements of an expression from its first on, evaluated as they are read.
+/**
+ * A kernel reading a Lazy computes its input on the fly, without a series
+ * in memory, e.g. the indicators of price<PRICE_TYPICAL>(candles).
+ */
+template <typename E>
+struct Lazy {
+    E e;
+    TA_Integer first;
+
+    Lazy (const E &_e, TA_Integer _first): e(_e), first(_first) {
+    }
+
+    typename E::value_type operator [] (TA_Integer i) const {
+        return e[first + i];
+    }
+};
+
+template <typename E>
+Lazy<E> elements (const Expr<E> &input)
+{
+    return Lazy<E>(input.get(), input.getFirst());
+}
+
+/// Blocked evaluation of the linear recurrence y[i] = a y[i - 1] + b u[i].
+/**
+ * Evaluated directly, the recurrence produces one output per multiply-add
+ * latency.  Within a block of BLOCK outputs starting at i0,
+ * y[i0 + j] = a^(j + 1) y[i0 - 1] + l[j], where the local part l follows the
+ * same recurrence from zero.  The local parts of successive blocks do not
+ * depend on each other, so the CPU overlaps them, the fix-up with
+ * y[i0 - 1] vectorizes, and only one multiply-add per block remains on the
+ * serial path.  With |a| <= 1 the results differ from the direct evaluation
+ * by rounding only.
+ */
+struct Recurrence {
+    enum { BLOCK = 8 };
+
+    double a, b;
+    // power[j] = a^(j + 1).
+    double power[BLOCK];
+
+    Recurrence (double _a, double _b): a(_a), b(_b) {
+        double p = 1;
+        for (int j = 0; j < BLOCK; ++j) {
+            p *= a;
+            power[j] = p;
+        }
+    }
+
+    /// Evaluate y[i] for from <= i < n given y[from - 1] = carry.
+    /**
+     * Writes out[i - begin] = y[i] * scale for every i >= begin, and
+     * returns the last y.
+     */
+    template <typename U, typename T>
+    TAPP_INLINE double run (const U &u, TA_Integer from, TA_Integer n, double carry,
+                            TA_Integer begin, double scale, T *out) const {
+        TA_Integer i = from;
+        for (; i + BLOCK <= n; i += BLOCK) {
+            double local[BLOCK];
+            double l = 0;
+            for (int j = 0; j < BLOCK; ++j) {
+                l = a * l + b * u[i + j];
+                local[j] = l;
+            }
+            int j = i >= begin ? 0 : int(std::min<TA_Integer>(begin - i, BLOCK));
+            for (; j < BLOCK; ++j) out[i + j - begin] = T((power[j] * carry + local[j]) * scale);
+            carry = power[BLOCK - 1] * carry + local[BLOCK - 1];
+        }
+        for (; i < n; ++i) {
+            carry = a * carry + b * u[i];
+            if (i >= begin) out[i - begin] = T(carry * scale);
+        }
+        return carry;
+    }
+};
+
+/// Differences of input elements period apart, the updates of a window sum.
+template <typename I>
+struct WindowDelta {
+    I in;
+    TA_Integer period;
+
+    WindowDelta (I _in, TA_Integer _period): in(_in), period(_period) {
+    }
+
+    double operator [] (TA_Integer i) const {
+        return double(in[i]) - double(in[i - period]);
+    }
+};
+
+/// Extremum of a sliding window with TA-lib's choice among equal values.
+/**
+ * TA-lib rescans the window whenever its extremum leaves it, which costs
+ * O(period) per output on trending data.  A monotonic deque of candidate
+ * indices finds the same extremum in amortized constant time, whatever the
+ * period.  The deque keeps the earliest of equal values, or the latest if
+ * latest is set, which is what a rescan finds.  Between rescans TA-lib moves
+ * to a new element that equals the extremum, and so does next().
+ *
+ * MAX selects the maximum, otherwise the minimum.  The window ends at the
+ * element pushed last and starts at trailing, and holds at most window
+ * elements.
+ *
+ * Each step depends on the previous one, so the kernels using Extremum
+ * are not run through dispatch(), see ta++-math.h.
+ */
+template <bool MAX, typename I>
+class Extremum {
+    I in;
+    bool latest;
+    // Ring buffer of candidates, their values monotonic from head on.
+    std::vector<TA_Integer> queue;
+    TA_Integer head, size;
+    TA_Integer index;
+
+    static bool better (double a, double b) {
+        return MAX ? a > b : a < b;
+    }
+
+    TA_Integer &at (TA_Integer k) {
+        TA_Integer i = head + k;
+        return queue[i < TA_Integer(queue.size()) ? i : i - queue.size()];
+    }
+
+public:
+    Extremum (I _in, TA_Integer window, bool _latest = false)
+        : in(_in), latest(_latest), queue(window + 1), head(0), size(0), index(-1) {
+    }
+
+    /// Add element t to the window and drop the elements before trailing.
+    void push (TA_Integer t, TA_Integer trailing) {
+        double v = in[t];
+        while (size > 0) {
+            double b = in[at(size - 1)];
+            if (latest ? better(b, v) : !better(v, b)) break;
+            --size;
+        }
+        at(size++) = t;
+        while (queue[head] < trailing) {
+            if (++head == TA_Integer(queue.size())) head = 0;
+            --size;
+        }
+    }
+
+    /// Push element t and return the index of the extremum as TA-lib does.
+    /**
+     * The first call finds the extremum as a rescan does.
+     */
+    TA_Integer next (TA_Integer t, TA_Integer trailing) {
+        push(t, trailing);
+        if (index < 0 || index < trailing) index = queue[head];
+        else if (!better(in[index], in[t])) index = t;
+        return index;
+    }
+};
+
+}
+
+/// Periods for which the runtime kernels use compile-time kernels.
+#define TAPP_FIXED_PERIODS(_X) _X(5) _X(10) _X(14) _X(20) _X(50) _X(200)
+
+}
+
+#include "ta++-math.h"
+#include "ta++-statistic.h"
+#include "ta++-overlap.h"
+#include "ta++-momentum.h"
+#include "ta++-cycle.h"
+#include "ta++-volatility.h"
+#include "ta++-volume.h"
+#include "ta++-price.h"
+#include "ta++-pattern.h"
+
+namespace tapp {
+
+/// TA functions with native implementations, in alphabetical order.
+#define TAPP_NATIVE_FUNCTIONS(_X) \
+    _X(AD) _X(ADD) _X(ADOSC) _X(ADX) _X(ADXR) _X(APO) _X(AROON) \
+    _X(AROONOSC) _X(ATR) _X(AVGPRICE) _X(BBANDS) _X(BETA) _X(CMO) \
+    _X(CORREL) _X(DEMA) _X(DIV) _X(DX) _X(EMA) _X(HT_DCPERIOD) \
+    _X(HT_DCPHASE) _X(HT_PHASOR) _X(HT_SINE) _X(HT_TRENDLINE) \
+    _X(HT_TRENDMODE) _X(KAMA) _X(LINEARREG) _X(LINEARREG_ANGLE) \
+    _X(LINEARREG_INTERCEPT) _X(LINEARREG_SLOPE) _X(MACD) _X(MACDEXT) \
+    _X(MACDFIX) _X(MAVP) _X(MAX) _X(MAXINDEX) _X(MEDPRICE) _X(MIDPOINT) \
+    _X(MIDPRICE) _X(MIN) _X(MININDEX) _X(MINMAX) _X(MINMAXINDEX) \
+    _X(MINUS_DI) _X(MINUS_DM) _X(MOM) _X(MULT) _X(NATR) _X(OBV) \
+    _X(PLUS_DI) _X(PLUS_DM) _X(PPO) _X(ROC) _X(ROCP) _X(ROCR) _X(ROCR100) \
+    _X(RSI) _X(SAR) _X(SAREXT) _X(SMA) _X(STDDEV) _X(STOCH) _X(STOCHF) \
+    _X(STOCHRSI) _X(SUB) _X(SUM) _X(T3) _X(TEMA) _X(TRANGE) _X(TRIMA) \
+    _X(TRIX) _X(TSF) _X(TYPPRICE) _X(VAR) _X(WCLPRICE) _X(WILLR) _X(WMA)
+
+/// The native implementations in one precision.
+/**
+ * The table is a template of the value type, so that only the kernels of
+ * the precisions actually used are compiled: a program using TA but not
+ * FloatTA does not compile the float kernels.
+ */
+template <typename T>
+class NativeTable
+{
+    static const NativeFunction<T> *functions (unsigned &size) {
+#define TAPP_NATIVE_ENTRY(_name) { #_name, &native::call##_name<T> },
+        static const NativeFunction<T> table[] = {
+            TAPP_NATIVE_FUNCTIONS(TAPP_NATIVE_ENTRY)
+        };
+#undef TAPP_NATIVE_ENTRY
+        size = sizeof(table) / sizeof(table[0]);
+        return table;
+    }
+public:
+    /// Number of native functions.
+    static unsigned size () {
+        unsigned n;
+        functions(n);
+        return n;
+    }
+
+    /// Get the i-th native function.
+    static const NativeFunction<T> &get (unsigned i) {
+        unsigned n;
+        return functions(n)[i];
+    }
+
+    /// Look up a function by name, returns 0 if it is not native.
+    static const NativeFunction<T> *find (const std::string &name) {
+        unsigned n;
+        const NativeFunction<T> *table = functions(n);
+        for (unsigned i = 0; i < n; ++i) {
+            if (name == table[i].name) return &table[i];
+        }
+        return 0;
+    }
+};
+
+template <typename T>
+static inline const NativeFunction<T> *findNative (const std::string &name)
+{
+#ifdef TAPP_NO_NATIVE
+    (void)name;
+    return 0;
+#else
+    return NativeTable<T>::find(name);
+#endif
+}
+
+}
+
+#endif
+
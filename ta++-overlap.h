@@ -0,0 +1,1234 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_OVERLAP
+#define WDONG_TAPP_OVERLAP
+
+/**
+ * \file ta++-overlap.h
+ * \brief Native overlap studies.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+namespace tapp {
+
+namespace native {
+
+/// Windows up to this period are summed directly instead of with a running sum.
+static const int SMA_UNROLL = 16;
+
+/// Simple moving average kernel.
+/**
+ * P is the period if it is known at compile time, or 0 if it is given at
+ * runtime.  Short fixed windows are summed directly for every output, with
+ * the loop over the window unrolled, so outputs are independent and the loop
+ * over them vectorizes.  Other windows slide a running sum, updated in
+ * blocks by Recurrence.  The lookback is period - 1.
+ */
+template <int P, typename I, typename T>
+struct Sma {
+    I in;
+    TA_Integer n, runtimePeriod, begin;
+    T *out;
+    Recurrence sum;
+
+    Sma (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _begin, T *_out)
+        : in(_in), n(_n), runtimePeriod(_period), begin(_begin), out(_out), sum(1, 1) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        const TA_Integer period = P > 0 ? P : runtimePeriod;
+        if (P > 0 && P <= SMA_UNROLL) {
+            for (TA_Integer i = begin; i < n; ++i) {
+                double total = 0;
+                for (TA_Integer k = period - 1; k >= 0; --k) total += in[i - k];
+                out[i - begin] = T(total / period);
+            }
+            return;
+        }
+        double total = 0;
+        for (TA_Integer i = begin - period + 1; i <= begin; ++i) total += in[i];
+        out[0] = T(total / period);
+        sum.run(WindowDelta<I>(in, period), begin + 1, n, total, begin, 1.0 / period, out);
+    }
+};
+
+/// Simple moving average over a period fixed at compile time.
+template <int P, typename I, typename T>
+void sma (I in, TA_Integer n, TA_Integer begin, T *out)
+{
+    dispatch(Sma<P, I, T>(in, n, P, begin, out));
+}
+
+/// Simple moving average.
+/**
+ * Common periods go to the compile-time kernels.
+ */
+template <typename I, typename T>
+void sma (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+#define TAPP_CASE(_p) case _p: sma<_p>(in, n, begin, out); return;
+    switch (period) {
+    TAPP_FIXED_PERIODS(TAPP_CASE)
+    default: dispatch(Sma<0, I, T>(in, n, period, begin, out));
+    }
+#undef TAPP_CASE
+}
+
+/// Exponential moving average kernel.
+/**
+ * With TA-lib's default compatibility the average is seeded with the simple
+ * average of the first period elements, otherwise with the first element,
+ * as Metastock does.  The lookback is period - 1, plus any unstable period.
+ */
+template <typename I, typename T>
+struct Ema {
+    I in;
+    TA_Integer n, period, begin;
+    bool metastock;
+    T *out;
+    Recurrence average;
+
+    Ema (I _in, TA_Integer _n, TA_Integer _period, double k, TA_Integer _begin, bool _metastock, T *_out)
+        : in(_in), n(_n), period(_period), begin(_begin), metastock(_metastock), out(_out), average(1 - k, k) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        double seed = in[0];
+        TA_Integer from = 1;
+        if (!metastock) {
+            seed = 0;
+            for (TA_Integer i = 0; i < period; ++i) seed += in[i];
+            seed /= period;
+            from = period;
+        }
+        if (from - 1 >= begin) out[from - 1 - begin] = T(seed);
+        average.run(in, from, n, seed, begin, 1, out);
+    }
+};
+
+/// Exponential moving average with smoothing factor k.
+template <typename I, typename T>
+void ema (I in, TA_Integer n, TA_Integer period, double k, TA_Integer begin, T *out)
+{
+    dispatch(Ema<I, T>(in, n, period, k, begin, !defaultCompatibility(), out));
+}
+
+/// Exponential moving average.
+template <typename I, typename T>
+void ema (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+    ema(in, n, period, 2.0 / (period + 1), begin, out);
+}
+
+/// Weighted moving average kernel.
+/**
+ * P is the period if it is known at compile time, or 0 if it is given at
+ * runtime.  Short fixed windows are weighted directly for every output, so
+ * the loop over outputs vectorizes.  Other windows use TA-lib's running
+ * weighted and simple sums.  The lookback is period - 1.
+ */
+template <int P, typename I, typename T>
+struct Wma {
+    I in;
+    TA_Integer n, runtimePeriod, begin;
+    T *out;
+
+    Wma (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _begin, T *_out)
+        : in(_in), n(_n), runtimePeriod(_period), begin(_begin), out(_out) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        const TA_Integer period = P > 0 ? P : runtimePeriod;
+        const double divider = double(period) * (period + 1) / 2;
+        if (P > 0 && P <= SMA_UNROLL) {
+            for (TA_Integer i = begin; i < n; ++i) {
+                double total = 0;
+                for (TA_Integer k = period - 1; k >= 0; --k) total += double(in[i - k]) * (period - k);
+                out[i - begin] = T(total / divider);
+            }
+            return;
+        }
+        double weighted = 0, simple = 0, trailing = 0;
+        TA_Integer i = 0;
+        for (; i < period - 1; ++i) {
+            simple += in[i];
+            weighted += double(in[i]) * (i + 1);
+        }
+        for (; i < n; ++i) {
+            double v = in[i];
+            simple += v - trailing;
+            weighted += v * period;
+            trailing = in[i - period + 1];
+            if (i >= begin) out[i - begin] = T(weighted / divider);
+            weighted -= simple;
+        }
+    }
+};
+
+/// Weighted moving average over a period fixed at compile time.
+template <int P, typename I, typename T>
+void wma (I in, TA_Integer n, TA_Integer begin, T *out)
+{
+    dispatch(Wma<P, I, T>(in, n, P, begin, out));
+}
+
+/// Weighted moving average.
+template <typename I, typename T>
+void wma (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+#define TAPP_CASE(_p) case _p: wma<_p>(in, n, begin, out); return;
+    switch (period) {
+    TAPP_FIXED_PERIODS(TAPP_CASE)
+    default: dispatch(Wma<0, I, T>(in, n, period, begin, out));
+    }
+#undef TAPP_CASE
+}
+
+/// Triangular moving average.
+/**
+ * The triangular weights are the convolution of two boxes, so the average
+ * is computed as a simple average of a simple average, of (period + 1) / 2
+ * elements each for odd periods, and of period / 2 and period / 2 + 1
+ * elements for even periods.  The lookback is period - 1.
+ */
+template <typename I, typename T>
+void trima (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+    TA_Integer first = period / 2 + 1;
+    TA_Integer second = (period + 1) / 2;
+    std::vector<double> inner(n - first + 1);
+    sma(in, n, first, first - 1, &inner[0]);
+    sma(&inner[0], TA_Integer(inner.size()), second, begin - first + 1, out);
+}
+
+/// Maximal number of averages a ribbon computes in one pass.
+static const int RIBBON_WIDTH = 16;
+
+/// Kernel of exponential or simple moving averages of several periods.
+/**
+ * The input is read once and one state per period is kept.  In the steady
+ * state the loop runs over periods, each advanced through RIBBON_BLOCK
+ * input elements while the state stays in a register, so the periods'
+ * dependency chains overlap.  Row i - begin of the output holds the
+ * averages of input element i side by side, stride elements apart from
+ * the next row; an average not defined yet at element i is 0.  The EMAs
+ * follow TA-lib step by step, the SMAs up to rounding.
+ */
+template <bool EXPONENTIAL, typename I, typename T>
+struct Ribbon {
+    enum { RIBBON_BLOCK = 8 };
+
+    I in;
+    TA_Integer n;
+    const TA_Integer *periods;
+    int count;
+    TA_Integer begin;
+    bool metastock;
+    T *out;
+    TA_Integer stride;
+
+    Ribbon (I _in, TA_Integer _n, const TA_Integer *_periods, int _count, TA_Integer _begin,
+            bool _metastock, T *_out, TA_Integer _stride)
+        : in(_in), n(_n), periods(_periods), count(_count), begin(_begin),
+        metastock(_metastock), out(_out), stride(_stride) {
+    }
+
+    // Advance all states through M elements from i and write their rows.
+    template <int M>
+    TAPP_INLINE void advance (TA_Integer i, double *state, const double *k) const {
+        T *row = out + (i - begin) * stride;
+        for (int j = 0; j < count; ++j) {
+            double s = state[j];
+            if (EXPONENTIAL) {
+                const double kj = k[j];
+                for (int t = 0; t < M; ++t) {
+                    s = ((double(in[i + t]) - s) * kj) + s;
+                    row[t * stride + j] = T(s);
+                }
+            }
+            else {
+                const TA_Integer lag = periods[j];
+                const double scale = 1.0 / lag;
+                for (int t = 0; t < M; ++t) {
+                    s += double(in[i + t]) - double(in[i + t - lag]);
+                    row[t * stride + j] = T(s * scale);
+                }
+            }
+            state[j] = s;
+        }
+    }
+
+    TAPP_INLINE void operator () () const {
+        double state[RIBBON_WIDTH], k[RIBBON_WIDTH];
+        TA_Integer seed[RIBBON_WIDTH];
+        TA_Integer warm = begin;
+        for (int j = 0; j < count; ++j) {
+            k[j] = 2.0 / (periods[j] + 1);
+            seed[j] = EXPONENTIAL && metastock ? 0 : periods[j] - 1;
+            state[j] = 0;
+            warm = std::max(warm, seed[j] + 1);
+        }
+        // Warm up until every average is defined and rows are due.
+        double prefix = 0;
+        TA_Integer i = 0;
+        for (; i < n && i < warm; ++i) {
+            double x = in[i];
+            prefix += x;
+            for (int j = 0; j < count; ++j) {
+                if (!EXPONENTIAL) {
+                    state[j] += x;
+                    if (i > seed[j]) state[j] -= in[i - periods[j]];
+                }
+                else if (i == seed[j]) state[j] = metastock ? x : prefix / periods[j];
+                else if (i > seed[j]) state[j] = ((x - state[j]) * k[j]) + state[j];
+            }
+            if (i < begin) continue;
+            T *row = out + (i - begin) * stride;
+            for (int j = 0; j < count; ++j) {
+                if (i < seed[j]) row[j] = 0;
+                else row[j] = T(EXPONENTIAL ? state[j] : state[j] / periods[j]);
+            }
+        }
+        for (; i + RIBBON_BLOCK <= n; i += RIBBON_BLOCK) advance<RIBBON_BLOCK>(i, state, k);
+        for (; i < n; ++i) advance<1>(i, state, k);
+    }
+};
+
+/// Moving averages of several periods over one input, side by side.
+/**
+ * Output row i - begin holds the averages of input element i in the order
+ * of the periods, with 0 for those not defined yet.  Up to RIBBON_WIDTH
+ * periods are computed in one pass over the input.  The periods must be at
+ * least 2, as TA-lib's, and begin at least the smallest period - 1.
+ */
+template <bool EXPONENTIAL, typename I, typename T>
+void ribbon (I in, TA_Integer n, const std::vector<TA_Integer> &periods, TA_Integer begin, T *out)
+{
+    TA_Integer stride = periods.size();
+    for (TA_Integer g = 0; g < stride; g += RIBBON_WIDTH) {
+        int count = int(std::min<TA_Integer>(RIBBON_WIDTH, stride - g));
+        dispatch(Ribbon<EXPONENTIAL, I, T>(in, n, &periods[g], count, begin,
+                    EXPONENTIAL && !defaultCompatibility(), out + g, stride));
+    }
+}
+
+/// Moving averages of several periods over a series.
+template <bool EXPONENTIAL, typename T>
+std::vector<Series<T> > ribbon (const Series<T> &input, const std::vector<TA_Integer> &periods)
+{
+    std::vector<Series<T> > outputs(periods.size());
+    if (periods.empty()) return outputs;
+    for (unsigned j = 0; j < periods.size(); ++j) {
+        verify(periods[j] > 1);
+    }
+    TA_Integer begin = *std::min_element(periods.begin(), periods.end()) - 1;
+    TA_Integer n = prepareOutput(input, begin, outputs[0]);
+    for (unsigned j = 0; j < periods.size(); ++j) {
+        prepareOutput(input, periods[j] - 1, outputs[j]);
+    }
+    if (n == 0) return outputs;
+    std::vector<T> rows((n - begin) * periods.size());
+    ribbon<EXPONENTIAL>(native::elements(input), n, periods, begin, &rows[0]);
+    for (unsigned j = 0; j < periods.size(); ++j) {
+        T *output = &outputs[j][input.getFirst()];
+        const T *row = &rows[(periods[j] - 1 - begin) * periods.size() + j];
+        for (TA_Integer i = periods[j] - 1; i < n; ++i, row += periods.size()) output[i] = *row;
+    }
+    return outputs;
+}
+
+/// Moving average of a TA-lib type.
+/**
+ * Returns false without computing anything if the type has no native
+ * kernel.  Like TA-lib, a period of 1 copies the input.  The lookback is
+ * that of the type.
+ */
+template <typename I, typename T>
+bool movingAverage (TA_MAType type, I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+    if (period == 1) {
+        for (TA_Integer i = begin; i < n; ++i) out[i - begin] = T(in[i]);
+        return true;
+    }
+    switch (type) {
+    case TA_MAType_SMA: sma(in, n, period, begin, out); return true;
+    case TA_MAType_EMA: ema(in, n, period, begin, out); return true;
+    case TA_MAType_WMA: wma(in, n, period, begin, out); return true;
+    case TA_MAType_TRIMA: trima(in, n, period, begin, out); return true;
+    default: return false;
+    }
+}
+
+/// Windows of MAVP's simple averages span at most two anchor blocks this long.
+static const TA_Integer MAVP_ANCHOR = 1024;
+
+/// Simple moving averages of a period per element.
+/**
+ * Writes out[i - begin] = the average of the period[i] elements ending at
+ * element i, for i >= begin, in constant time per element whatever the
+ * periods.  The window sums are differences of prefix sums about the first
+ * element of each block of max(MAVP_ANCHOR, maxPeriod) elements, so a
+ * window spans at most two blocks and the sums stay small, like those of
+ * TA-lib's running sum.
+ */
+template <typename I, typename T>
+void variableSMA (I in, TA_Integer n, const TA_Integer *period, TA_Integer maxPeriod, TA_Integer begin, T *out)
+{
+    const TA_Integer block = std::max(MAVP_ANCHOR, maxPeriod);
+    // prefix[i] is the sum of in[j] - anchor[i / block] from the start of
+    // the block of i to i inclusive.
+    std::vector<double> prefix(n), anchor((n + block - 1) / block);
+    for (TA_Integer b = 0; b * block < n; ++b) {
+        TA_Integer b0 = b * block, e = std::min(n, b0 + block);
+        double a = in[b0], sum = 0;
+        anchor[b] = a;
+        for (TA_Integer i = b0; i < e; ++i) {
+            sum += double(in[i]) - a;
+            prefix[i] = sum;
+        }
+    }
+    for (TA_Integer i = begin; i < n; ++i) {
+        TA_Integer p = period[i - begin];
+        TA_Integer b = i / block, b0 = b * block, s = i - p;
+        double sum = prefix[i] + (i - b0 + 1) * anchor[b];
+        if (s >= b0) sum -= prefix[s] + (s - b0 + 1) * anchor[b];
+        // Otherwise the window may start in the previous block.
+        else if (s < b0 - 1) sum += (prefix[b0 - 1] - prefix[s]) + (b0 - 1 - s) * anchor[b - 1];
+        out[i - begin] = T(sum / p);
+    }
+}
+
+/// Moving average of a period per element, TA-lib's MAVP.
+/**
+ * Periods are truncated and clamped to [minPeriod, maxPeriod] as TA-lib
+ * does, and begin must be the lookback of the type for maxPeriod.  Simple
+ * averages come from variableSMA().  For the other types, TA-lib computes
+ * the average of each period present with its own start, lookback elements
+ * before begin, and so does this function, with one native pass per
+ * period present.  Returns false without computing anything if the type
+ * has no native kernel.
+ */
+template <typename I, typename P, typename T>
+bool variableAverage (I in, P periods, TA_Integer n, TA_Integer minPeriod, TA_Integer maxPeriod, TA_MAType type,
+                      TA_Integer begin, T *out)
+{
+    if (type != TA_MAType_SMA && type != TA_MAType_EMA && type != TA_MAType_WMA && type != TA_MAType_TRIMA) {
+        return false;
+    }
+    std::vector<TA_Integer> period(n - begin);
+    std::vector<bool> present(maxPeriod + 1, false);
+    for (TA_Integer i = begin; i < n; ++i) {
+        TA_Integer p = TA_Integer(periods[i]);
+        if (p < minPeriod) p = minPeriod;
+        else if (p > maxPeriod) p = maxPeriod;
+        period[i - begin] = p;
+        present[p] = true;
+    }
+    if (type == TA_MAType_SMA) {
+        variableSMA(in, n, &period[0], maxPeriod, begin, out);
+        return true;
+    }
+    std::vector<double> average(n - begin);
+    for (TA_Integer p = minPeriod; p <= maxPeriod; ++p) {
+        if (!present[p]) continue;
+        TA_Integer skip = begin - TA_MA_Lookback(p, type);
+        movingAverage(type, in + skip, n - skip, p, begin - skip, &average[0]);
+        for (TA_Integer i = 0; i < n - begin; ++i) {
+            if (period[i] == p) out[i] = T(average[i]);
+        }
+    }
+    return true;
+}
+
+/// Bollinger bands kernel.
+/**
+ * The middle band is the moving average of the given type, and the bands
+ * are nbDevUp and nbDevDn standard deviations about it.  As in TA-lib the
+ * deviation is about the simple mean whatever the type.  All three bands
+ * come from one pass of the rolling variance, which also gives the middle
+ * band of the SMA type.  Returns false if the type has no native kernel.
+ * The lookback is that of the moving average.
+ */
+template <typename I, typename T>
+bool bbands (I in, TA_Integer n, TA_Integer period, double nbDevUp, double nbDevDn, TA_MAType type,
+             TA_Integer begin, T *upper, T *middle, T *lower)
+{
+    TA_Integer m = n - begin;
+    std::vector<double> mean(m), var(m), average;
+    if (type != TA_MAType_SMA) {
+        average.resize(m);
+        if (!movingAverage(type, in, n, period, begin, &average[0])) return false;
+    }
+    variance(in, n, period, begin, &mean[0], &var[0]);
+    const std::vector<double> &mid = average.empty() ? mean : average;
+    for (TA_Integer i = 0; i < m; ++i) {
+        double dev = deviation(var[i]);
+        upper[i] = T(mid[i] + dev * nbDevUp);
+        middle[i] = T(mid[i]);
+        lower[i] = T(mid[i] - dev * nbDevDn);
+    }
+    return true;
+}
+
+/// Midpoint of the highest and lowest values of one or two inputs.
+/**
+ * The lookback is period - 1.
+ */
+template <typename I, typename T>
+void midpoint (I high, I low, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+    Extremum<true, I> highest(high, period);
+    Extremum<false, I> lowest(low, period);
+    for (TA_Integer i = begin - period + 1; i < begin; ++i) {
+        highest.push(i, i - period + 1);
+        lowest.push(i, i - period + 1);
+    }
+    for (TA_Integer i = begin; i < n; ++i) {
+        TA_Integer h = highest.next(i, i - period + 1);
+        TA_Integer l = lowest.next(i, i - period + 1);
+        out[i - begin] = T((double(high[h]) + double(low[l])) / 2.0);
+    }
+}
+
+/// EMA stages of DEMA, 2 * e1 - e2.
+struct DemaStages {
+    enum { STAGES = 2 };
+    double k;
+
+    explicit DemaStages (TA_Integer period): k(2.0 / (period + 1)) {
+    }
+
+    TAPP_INLINE double step (double u, double e) const { return (u - e) * k + e; }
+    TAPP_INLINE double operator () (const double *e, double) const { return 2.0 * e[0] - e[1]; }
+};
+
+/// EMA stages of TEMA, e3 + 3 * e1 - 3 * e2.
+struct TemaStages {
+    enum { STAGES = 3 };
+    double k;
+
+    explicit TemaStages (TA_Integer period): k(2.0 / (period + 1)) {
+    }
+
+    TAPP_INLINE double step (double u, double e) const { return (u - e) * k + e; }
+    TAPP_INLINE double operator () (const double *e, double) const { return e[2] + (3.0 * e[0] - 3.0 * e[1]); }
+};
+
+/// EMA stages of TRIX, the one-element rate of change of e3 in percent.
+struct TrixStages {
+    enum { STAGES = 3 };
+    double k;
+
+    explicit TrixStages (TA_Integer period): k(2.0 / (period + 1)) {
+    }
+
+    TAPP_INLINE double step (double u, double e) const { return (u - e) * k + e; }
+    TAPP_INLINE double operator () (const double *e, double last) const {
+        return last != 0.0 ? (e[2] / last - 1.0) * 100.0 : 0.0;
+    }
+};
+
+/// EMA stages of Tillson's T3, a polynomial in vFactor of e3 to e6.
+struct T3Stages {
+    enum { STAGES = 6 };
+    double k, rest, c1, c2, c3, c4;
+
+    T3Stages (TA_Integer period, double vFactor): k(2.0 / (period + 1.0)), rest(1.0 - k) {
+        double v2 = vFactor * vFactor;
+        c1 = -v2 * vFactor;
+        c2 = 3.0 * (v2 - c1);
+        c3 = -6.0 * v2 - 3.0 * (vFactor - c1);
+        c4 = 1.0 + 3.0 * vFactor - c1 + 3.0 * v2;
+    }
+
+    TAPP_INLINE double step (double u, double e) const { return k * u + rest * e; }
+    TAPP_INLINE double operator () (const double *e, double) const {
+        return c1 * e[5] + c2 * e[4] + c3 * e[3] + c4 * e[2];
+    }
+};
+
+/// Kernel of cascaded EMAs, each stage averaging the one before.
+/**
+ * S gives the number of stages, the step of each and the output from the
+ * stage values at an element and the last stage's value at the element
+ * before.  Stage s averages the values of stage s - 1 from element
+ * s * lag on, seeded by the mean of its first period inputs or, as
+ * Metastock does, by the first.  All stages advance together in one pass
+ * over the input with their state in registers, where TA-lib makes a pass
+ * per stage, and follow TA-lib step by step.
+ */
+template <typename S, typename I, typename T>
+struct Cascade {
+    I in;
+    TA_Integer n, period, lag, begin;
+    bool metastock;
+    S stages;
+    T *out;
+
+    Cascade (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _lag, bool _metastock, const S &_stages,
+             TA_Integer _begin, T *_out)
+        : in(_in), n(_n), period(_period), lag(_lag), begin(_begin), metastock(_metastock), stages(_stages), out(_out) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        enum { STAGES = S::STAGES };
+        double e[STAGES] = {0}, sum[STAGES] = {0}, last = 0;
+        const TA_Integer seeded = metastock ? 1 : period;
+        const TA_Integer warm = std::min(n, (STAGES - 1) * lag + seeded);
+        TA_Integer i = 0;
+        for (; i < warm; ++i) {
+            double u = in[i];
+            for (int s = 0; s < STAGES; ++s) {
+                TA_Integer j = i - s * lag;
+                if (j < 0) break;
+                if (j >= seeded) e[s] = stages.step(u, e[s]);
+                else {
+                    sum[s] = j == 0 ? u : sum[s] + u;
+                    if (j == seeded - 1) e[s] = sum[s] / seeded;
+                }
+                u = e[s];
+            }
+            if (i >= begin) out[i - begin] = T(stages(e, last));
+            last = e[STAGES - 1];
+        }
+        // Every stage is running from here on.
+        for (; i < n; ++i) {
+            double u = in[i];
+            for (int s = 0; s < STAGES; ++s) u = e[s] = stages.step(u, e[s]);
+            if (i >= begin) out[i - begin] = T(stages(e, last));
+            last = e[STAGES - 1];
+        }
+    }
+};
+
+/// Cascaded EMAs of the given stages, each with lookback lag.
+template <typename S, typename I, typename T>
+void cascade (I in, TA_Integer n, TA_Integer period, TA_Integer lag, const S &stages, TA_Integer begin, T *out)
+{
+    dispatch(Cascade<S, I, T>(in, n, period, lag, !defaultCompatibility(), stages, begin, out));
+}
+
+/// Double exponential moving average.
+/**
+ * Each EMA stage has lookback lag, period - 1 plus any unstable period of
+ * EMA, and the lookback is 2 * lag.
+ */
+template <typename I, typename T>
+void dema (I in, TA_Integer n, TA_Integer period, TA_Integer lag, TA_Integer begin, T *out)
+{
+    cascade(in, n, period, lag, DemaStages(period), begin, out);
+}
+
+/// Triple exponential moving average.
+/**
+ * Each EMA stage has lookback lag, and the lookback is 3 * lag.
+ */
+template <typename I, typename T>
+void tema (I in, TA_Integer n, TA_Integer period, TA_Integer lag, TA_Integer begin, T *out)
+{
+    cascade(in, n, period, lag, TemaStages(period), begin, out);
+}
+
+/// Rate of change of a triple exponential moving average.
+/**
+ * Each EMA stage has lookback lag, and the lookback is 3 * lag + 1.
+ */
+template <typename I, typename T>
+void trix (I in, TA_Integer n, TA_Integer period, TA_Integer lag, TA_Integer begin, T *out)
+{
+    cascade(in, n, period, lag, TrixStages(period), begin, out);
+}
+
+/// Tillson's T3 moving average.
+/**
+ * As in TA-lib the six stages are seeded by simple means whatever the
+ * compatibility.  The lookback is 6 * (period - 1), plus any unstable
+ * period of T3.
+ */
+template <typename I, typename T>
+void t3 (I in, TA_Integer n, TA_Integer period, double vFactor, TA_Integer begin, T *out)
+{
+    dispatch(Cascade<T3Stages, I, T>(in, n, period, period - 1, false, T3Stages(period, vFactor), begin, out));
+}
+
+/// Kaufman adaptive moving average kernel.
+/**
+ * The smoothing constant follows the efficiency ratio, the net change over
+ * period elements against the sum of the absolute changes, kept as a
+ * running sum.  Follows TA-lib step by step, including its comparison of
+ * the signed net change with the sum.  The lookback is period, plus any
+ * unstable period of KAMA.
+ */
+template <typename I, typename T>
+struct Kama {
+    I in;
+    TA_Integer n, period, begin;
+    T *out;
+
+    Kama (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _begin, T *_out)
+        : in(_in), n(_n), period(_period), begin(_begin), out(_out) {
+    }
+
+    TAPP_INLINE double smoothing (double change, double path) const {
+        static const double fastest = 2.0 / (2.0 + 1.0), slowest = 2.0 / (30.0 + 1.0);
+        double ratio = (path <= change || isZero(path)) ? 1.0 : std::fabs(change / path);
+        double c = ratio * (fastest - slowest) + slowest;
+        return c * c;
+    }
+
+    TAPP_INLINE void operator () () const {
+        double path = 0;
+        for (TA_Integer i = 0; i < period; ++i) path += std::fabs(double(in[i]) - double(in[i + 1]));
+        double x = in[period], trailing = in[0];
+        double kama = (x - double(in[period - 1])) * smoothing(x - trailing, path) + double(in[period - 1]);
+        if (period >= begin) out[period - begin] = T(kama);
+        for (TA_Integer i = period + 1; i < n; ++i) {
+            double previous = x, dropped = in[i - period];
+            x = in[i];
+            path -= std::fabs(trailing - dropped);
+            path += std::fabs(x - previous);
+            trailing = dropped;
+            kama = (x - kama) * smoothing(x - dropped, path) + kama;
+            if (i >= begin) out[i - begin] = T(kama);
+        }
+    }
+};
+
+/// Kaufman adaptive moving average.
+template <typename I, typename T>
+void kama (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *out)
+{
+    dispatch(Kama<I, T>(in, n, period, begin, out));
+}
+
+template <typename T>
+bool callSMA (const NativeCall<T> &call)
+{
+    sma(call.real[0], call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callEMA (const NativeCall<T> &call)
+{
+    ema(call.real[0], call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callWMA (const NativeCall<T> &call)
+{
+    wma(call.real[0], call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callTRIMA (const NativeCall<T> &call)
+{
+    trima(call.real[0], call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callBBANDS (const NativeCall<T> &call)
+{
+    return bbands(call.real[0], call.size, call.integer(0), call.options[1], call.options[2],
+                  TA_MAType(call.integer(3)), call.lookback, call.out[0], call.out[1], call.out[2]);
+}
+
+template <typename T>
+bool callMAVP (const NativeCall<T> &call)
+{
+    return variableAverage(call.real[0], call.real[1], call.size, call.integer(0), call.integer(1),
+                           TA_MAType(call.integer(2)), call.lookback, call.out[0]);
+}
+
+template <typename T>
+bool callMIDPOINT (const NativeCall<T> &call)
+{
+    midpoint(call.real[0], call.real[0], call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callMIDPRICE (const NativeCall<T> &call)
+{
+    midpoint(call.high, call.low, call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callDEMA (const NativeCall<T> &call)
+{
+    dema(call.real[0], call.size, call.integer(0), TA_EMA_Lookback(call.integer(0)), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callTEMA (const NativeCall<T> &call)
+{
+    tema(call.real[0], call.size, call.integer(0), TA_EMA_Lookback(call.integer(0)), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callTRIX (const NativeCall<T> &call)
+{
+    trix(call.real[0], call.size, call.integer(0), TA_EMA_Lookback(call.integer(0)), call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callT3 (const NativeCall<T> &call)
+{
+    t3(call.real[0], call.size, call.integer(0), call.options[1], call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callKAMA (const NativeCall<T> &call)
+{
+    kama(call.real[0], call.size, call.integer(0), call.lookback, call.out[0]);
+    return true;
+}
+
+}
+
+/// Simple moving average over a period fixed at compile time.
+/**
+ * The same as TA("SMA", input) with optInTimePeriod P, up to rounding.
+ */
+template <int P, typename S>
+Series<typename Operand<S>::value_type> sma (const S &input)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, P - 1, output) == 0) return output;
+    native::sma<P>(native::elements(input), input.size() - input.getFirst(), P - 1, &output[output.getFirst()]);
+    return output;
+}
+
+/// Simple moving average.
+template <typename S>
+Series<typename Operand<S>::value_type> sma (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period - 1, output) == 0) return output;
+    native::sma(native::elements(input), input.size() - input.getFirst(), period, period - 1, &output[output.getFirst()]);
+    return output;
+}
+
+/// Exponential moving averages of several periods, computed in one pass.
+/**
+ * Output j is the same as ema(input, periods[j]).  This is much cheaper
+ * than computing the averages one by one, e.g. for moving average ribbons,
+ * see native::ribbon() for the side by side layout.  Every period must be
+ * at least 2.
+ */
+template <typename T>
+std::vector<Series<T> > emaRibbon (const Series<T> &input, const std::vector<TA_Integer> &periods)
+{
+    return native::ribbon<true>(input, periods);
+}
+
+/// Simple moving averages of several periods, computed in one pass.
+/**
+ * Output j is the same as sma(input, periods[j]) up to rounding.  Every
+ * period must be at least 2.
+ */
+template <typename T>
+std::vector<Series<T> > smaRibbon (const Series<T> &input, const std::vector<TA_Integer> &periods)
+{
+    return native::ribbon<false>(input, periods);
+}
+
+/// Exponential moving average.
+/**
+ * The same as TA("EMA", input) with optInTimePeriod period and no unstable
+ * period, up to rounding.
+ */
+template <typename S>
+Series<typename Operand<S>::value_type> ema (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period - 1, output) == 0) return output;
+    native::ema(native::elements(input), input.size() - input.getFirst(), period, period - 1, &output[output.getFirst()]);
+    return output;
+}
+
+/// Weighted moving average over a period fixed at compile time.
+template <int P, typename S>
+Series<typename Operand<S>::value_type> wma (const S &input)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, P - 1, output) == 0) return output;
+    native::wma<P>(native::elements(input), input.size() - input.getFirst(), P - 1, &output[output.getFirst()]);
+    return output;
+}
+
+/// Weighted moving average.
+template <typename S>
+Series<typename Operand<S>::value_type> wma (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period - 1, output) == 0) return output;
+    native::wma(native::elements(input), input.size() - input.getFirst(), period, period - 1, &output[output.getFirst()]);
+    return output;
+}
+
+/// Triangular moving average.
+template <typename S>
+Series<typename Operand<S>::value_type> trima (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period - 1, output) == 0) return output;
+    native::trima(native::elements(input), input.size() - input.getFirst(), period, period - 1, &output[output.getFirst()]);
+    return output;
+}
+
+/// Midpoint of the highest and lowest values over a period.
+template <typename S>
+Series<typename Operand<S>::value_type> midpoint (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period - 1, output) == 0) return output;
+    native::midpoint(native::elements(input), native::elements(input), input.size() - input.getFirst(), period, period - 1, &output[output.getFirst()]);
+    return output;
+}
+
+/// Double exponential moving average.
+/**
+ * The same as TA("DEMA", input) with optInTimePeriod period and no
+ * unstable period.
+ */
+template <typename S>
+Series<typename Operand<S>::value_type> dema (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, 2 * (period - 1), output) == 0) return output;
+    native::dema(native::elements(input), input.size() - input.getFirst(), period, period - 1, 2 * (period - 1),
+                 &output[output.getFirst()]);
+    return output;
+}
+
+/// Triple exponential moving average.
+/**
+ * The same as TA("TEMA", input) with optInTimePeriod period and no
+ * unstable period.
+ */
+template <typename S>
+Series<typename Operand<S>::value_type> tema (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, 3 * (period - 1), output) == 0) return output;
+    native::tema(native::elements(input), input.size() - input.getFirst(), period, period - 1, 3 * (period - 1),
+                 &output[output.getFirst()]);
+    return output;
+}
+
+/// Rate of change in percent of a triple exponential moving average.
+/**
+ * The same as TA("TRIX", input) with optInTimePeriod period and no
+ * unstable period.
+ */
+template <typename S>
+Series<typename Operand<S>::value_type> trix (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, 3 * (period - 1) + 1, output) == 0) return output;
+    native::trix(native::elements(input), input.size() - input.getFirst(), period, period - 1, 3 * (period - 1) + 1,
+                 &output[output.getFirst()]);
+    return output;
+}
+
+/// Tillson's T3 moving average.
+/**
+ * The same as TA("T3", input) with optInTimePeriod period, optInVFactor
+ * vFactor and no unstable period.
+ */
+template <typename S>
+Series<typename Operand<S>::value_type> t3 (const S &input, TA_Integer period = 5, double vFactor = 0.7)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, 6 * (period - 1), output) == 0) return output;
+    native::t3(native::elements(input), input.size() - input.getFirst(), period, vFactor, 6 * (period - 1),
+               &output[output.getFirst()]);
+    return output;
+}
+
+/// Kaufman adaptive moving average.
+/**
+ * The same as TA("KAMA", input) with optInTimePeriod period and no
+ * unstable period.
+ */
+template <typename S>
+Series<typename Operand<S>::value_type> kama (const S &input, TA_Integer period = 30)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    if (native::prepareOutput(input, period, output) == 0) return output;
+    native::kama(native::elements(input), input.size() - input.getFirst(), period, period, &output[output.getFirst()]);
+    return output;
+}
+
+/// Parabolic SAR of live bars.
+/**
+ * The state machine of TA-lib's SAR and SAREXT: the trend, its extreme
+ * point and the acceleration factors, advanced by one bar at a time in
+ * constant time.  The batch kernel native::parabolic() runs the same
+ * state, so after the same bars getSAR() and getSAREXT() are the last
+ * values of TA("SAR") and TA("SAREXT") with the options of the
+ * constructor.  There is no value before the second bar.
+ */
+class ParabolicState
+{
+    double startValue, offsetOnReverse;
+    double initLong, stepLong, maxLong, initShort, stepShort, maxShort;
+    TA_Integer count;
+    bool isLong;
+    double sar, extreme, accelerationLong, accelerationShort;
+    double previousHigh, previousLow, value;
+
+    void init (double _startValue, double _offsetOnReverse, double _initLong, double _stepLong, double _maxLong,
+               double _initShort, double _stepShort, double _maxShort) {
+        startValue = _startValue;
+        offsetOnReverse = _offsetOnReverse;
+        // TA-lib caps the accelerations at their maxima.
+        maxLong = _maxLong;
+        initLong = std::min(_initLong, maxLong);
+        stepLong = std::min(_stepLong, maxLong);
+        maxShort = _maxShort;
+        initShort = std::min(_initShort, maxShort);
+        stepShort = std::min(_stepShort, maxShort);
+        count = 0;
+        isLong = true;
+        sar = extreme = previousHigh = previousLow = value = 0;
+        accelerationLong = initLong;
+        accelerationShort = initShort;
+    }
+
+    // The first bar with a value, TA-lib's start of the trend.
+    void start (double high, double low) {
+        if (startValue == 0) {
+            // The sign of MINUS_DM over one bar.
+            double up = high - previousHigh, down = previousLow - low;
+            isLong = !(down > 0 && up < down);
+        }
+        else isLong = startValue > 0;
+        extreme = isLong ? high : low;
+        if (startValue == 0) sar = isLong ? previousLow : previousHigh;
+        else sar = std::fabs(startValue);
+        previousHigh = high;
+        previousLow = low;
+    }
+
+public:
+    /// State of SAR.
+    ParabolicState (double acceleration = 0.02, double maximum = 0.2) {
+        init(0, 0, acceleration, acceleration, maximum, acceleration, acceleration, maximum);
+    }
+
+    /// State of SAREXT, with its options in order.
+    ParabolicState (double _startValue, double _offsetOnReverse,
+                    double _initLong, double _stepLong, double _maxLong,
+                    double _initShort, double _stepShort, double _maxShort) {
+        init(_startValue, _offsetOnReverse, _initLong, _stepLong, _maxLong, _initShort, _stepShort, _maxShort);
+    }
+
+    /// Add the next bar.
+    void push (double high, double low) {
+        if (count++ == 0) {
+            previousHigh = high;
+            previousLow = low;
+            return;
+        }
+        if (count == 2) start(high, low);
+        if (isLong) {
+            if (low <= sar) {
+                isLong = false;
+                sar = extreme;
+                if (sar < previousHigh) sar = previousHigh;
+                if (sar < high) sar = high;
+                if (offsetOnReverse != 0.0) sar += sar * offsetOnReverse;
+                value = sar;
+                accelerationShort = initShort;
+                extreme = low;
+                sar = sar + accelerationShort * (extreme - sar);
+                if (sar < previousHigh) sar = previousHigh;
+                if (sar < high) sar = high;
+            }
+            else {
+                value = sar;
+                if (high > extreme) {
+                    extreme = high;
+                    accelerationLong += stepLong;
+                    if (accelerationLong > maxLong) accelerationLong = maxLong;
+                }
+                sar = sar + accelerationLong * (extreme - sar);
+                if (sar > previousLow) sar = previousLow;
+                if (sar > low) sar = low;
+            }
+        }
+        else {
+            if (high >= sar) {
+                isLong = true;
+                sar = extreme;
+                if (sar > previousLow) sar = previousLow;
+                if (sar > low) sar = low;
+                if (offsetOnReverse != 0.0) sar -= sar * offsetOnReverse;
+                value = sar;
+                accelerationLong = initLong;
+                extreme = high;
+                sar = sar + accelerationLong * (extreme - sar);
+                if (sar > previousLow) sar = previousLow;
+                if (sar > low) sar = low;
+            }
+            else {
+                value = sar;
+                if (low < extreme) {
+                    extreme = low;
+                    accelerationShort += stepShort;
+                    if (accelerationShort > maxShort) accelerationShort = maxShort;
+                }
+                sar = sar + accelerationShort * (extreme - sar);
+                if (sar < previousHigh) sar = previousHigh;
+                if (sar < high) sar = high;
+            }
+        }
+        previousHigh = high;
+        previousLow = low;
+    }
+
+    /// Add the next candle.
+    void push (const Candle &candle) {
+        push(candle.high, candle.low);
+    }
+
+    /// Number of bars added.
+    TA_Integer size () const {
+        return count;
+    }
+
+    /// Check whether the SAR is available, from bar 1 on.
+    bool ready () const {
+        return count > 1;
+    }
+
+    /// SAR of the last bar.
+    double getSAR () const {
+        return value;
+    }
+
+    /// SAR of the last bar, negative in a short trend as in SAREXT.
+    double getSAREXT () const {
+        return isLong ? value : -value;
+    }
+
+    /// Check whether the trend after the last bar is long.
+    bool getLong () const {
+        return isLong;
+    }
+
+    /// Extreme point of the current trend.
+    double getExtreme () const {
+        return extreme;
+    }
+
+    /// Acceleration factor of the current trend.
+    double getAcceleration () const {
+        return isLong ? accelerationLong : accelerationShort;
+    }
+
+    /// SAR of the next bar before it is capped by its range.
+    double getNextSAR () const {
+        return sar;
+    }
+};
+
+namespace native {
+
+/// Parabolic SAR kernel, running state over high and low.
+/**
+ * Writes out[i - begin] for i >= begin, the SAREXT value if extended and
+ * the SAR value otherwise.  begin must be at least 1.
+ */
+template <typename I, typename T>
+void parabolic (I high, I low, TA_Integer n, ParabolicState state, bool extended, TA_Integer begin, T *out)
+{
+    for (TA_Integer i = 0; i < n; ++i) {
+        state.push(high[i], low[i]);
+        if (i >= begin) out[i - begin] = T(extended ? state.getSAREXT() : state.getSAR());
+    }
+}
+
+template <typename T>
+bool callSAR (const NativeCall<T> &call)
+{
+    parabolic(call.high, call.low, call.size, ParabolicState(call.options[0], call.options[1]), false,
+              call.lookback, call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callSAREXT (const NativeCall<T> &call)
+{
+    const TA_Real *o = call.options;
+    parabolic(call.high, call.low, call.size, ParabolicState(o[0], o[1], o[2], o[3], o[4], o[5], o[6], o[7]), true,
+              call.lookback, call.out[0]);
+    return true;
+}
+
+}
+
+/// Parabolic SAR of candles.
+/**
+ * state holds the options and must not have seen any bar.  The result is
+ * the same as TA("SAR") with the options of ParabolicState(acceleration,
+ * maximum), or, if extended, as TA("SAREXT") with those of the SAREXT
+ * constructor.
+ */
+static inline RealSeries sar (const Candles &candles, const ParabolicState &state = ParabolicState(),
+                              bool extended = false)
+{
+    RealSeries r;
+    const RealSeries &high = candles.getHigh();
+    TA_Integer n = native::prepareOutput(high, 1, r);
+    if (n == 0) return r;
+    TA_Integer first = high.getFirst();
+    native::parabolic(&high[first], &candles.getLow()[first], n, state, extended, 1, &r[r.getFirst()]);
+    return r;
+}
+
+}
+
+#endif
+
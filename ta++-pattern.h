@@ -0,0 +1,990 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_PATTERN
+#define WDONG_TAPP_PATTERN
+
+/**
+ * \file ta++-pattern.h
+ * \brief Candlestick pattern scanner.
+ *
+ * CandleScan looks for any set of the 61 candlestick patterns of TA-lib
+ * and keeps, for each bar, a mask of the patterns found and their
+ * strengths.  A native kernel finds all of them in a single pass over the
+ * candles: the geometry of every candle is computed once, and the running
+ * totals of bodies, ranges and shadows that the patterns average are
+ * shared by the patterns for which TA-lib would compute the same totals.
+ *
+ * The patterns depend on TA-lib's candle settings, see CandleSettings.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+#include <boost/cstdint.hpp>
+
+namespace tapp {
+
+/// The candlestick pattern functions of TA-lib, without their CDL prefix.
+#define TAPP_CANDLE_PATTERNS(_X) \
+    _X(2CROWS) _X(3BLACKCROWS) _X(3INSIDE) _X(3LINESTRIKE) _X(3OUTSIDE) \
+    _X(3STARSINSOUTH) _X(3WHITESOLDIERS) _X(ABANDONEDBABY) _X(ADVANCEBLOCK) \
+    _X(BELTHOLD) _X(BREAKAWAY) _X(CLOSINGMARUBOZU) _X(CONCEALBABYSWALL) \
+    _X(COUNTERATTACK) _X(DARKCLOUDCOVER) _X(DOJI) _X(DOJISTAR) _X(DRAGONFLYDOJI) \
+    _X(ENGULFING) _X(EVENINGDOJISTAR) _X(EVENINGSTAR) _X(GAPSIDESIDEWHITE) \
+    _X(GRAVESTONEDOJI) _X(HAMMER) _X(HANGINGMAN) _X(HARAMI) _X(HARAMICROSS) \
+    _X(HIGHWAVE) _X(HIKKAKE) _X(HIKKAKEMOD) _X(HOMINGPIGEON) _X(IDENTICAL3CROWS) \
+    _X(INNECK) _X(INVERTEDHAMMER) _X(KICKING) _X(KICKINGBYLENGTH) _X(LADDERBOTTOM) \
+    _X(LONGLEGGEDDOJI) _X(LONGLINE) _X(MARUBOZU) _X(MATCHINGLOW) _X(MATHOLD) \
+    _X(MORNINGDOJISTAR) _X(MORNINGSTAR) _X(ONNECK) _X(PIERCING) _X(RICKSHAWMAN) \
+    _X(RISEFALL3METHODS) _X(SEPARATINGLINES) _X(SHOOTINGSTAR) _X(SHORTLINE) \
+    _X(SPINNINGTOP) _X(STALLEDPATTERN) _X(STICKSANDWICH) _X(TAKURI) _X(TASUKIGAP) \
+    _X(THRUSTING) _X(TRISTAR) _X(UNIQUE3RIVER) _X(UPSIDEGAP2CROWS) _X(XSIDEGAP3METHODS)
+
+#define TAPP_CANDLE_ENUM(_name) CANDLE_##_name,
+
+/// Candlestick patterns, in the order of TA-lib's functions.
+/**
+ * The pattern of TA-lib's CDLDOJI is CANDLE_DOJI, and so on.
+ */
+enum CandlePattern {
+    TAPP_CANDLE_PATTERNS(TAPP_CANDLE_ENUM)
+    CANDLE_PATTERNS
+};
+
+#undef TAPP_CANDLE_ENUM
+
+/// Set of candlestick patterns, one bit per CandlePattern.
+typedef boost::uint64_t CandleMask;
+
+/// Bit of a pattern in a CandleMask.
+#define TAPP_CANDLE(_pattern) (CandleMask(1) << (_pattern))
+
+/// All candlestick patterns.
+static const CandleMask ALL_CANDLE_PATTERNS = (CandleMask(1) << CANDLE_PATTERNS) - 1;
+
+/// Name of the TA function of a pattern.
+static inline const char *candlePatternName (CandlePattern pattern)
+{
+#define TAPP_CANDLE_NAME(_name) "CDL" #_name,
+    static const char *const names[] = { TAPP_CANDLE_PATTERNS(TAPP_CANDLE_NAME) };
+#undef TAPP_CANDLE_NAME
+    return names[pattern];
+}
+
+namespace native {
+
+/// One of TA-lib's candle settings, see TA_SetCandleSettings.
+struct CandleSetting {
+    TA_RangeType range;
+    TA_Integer period;
+    double factor;
+};
+
+/// Geometry of a candle, TA-lib's TA_REALBODY and related macros.
+struct CandleShape {
+    double body, upper, lower, range;
+    int color;
+
+    CandleShape (): body(0), upper(0), lower(0), range(0), color(1) {
+    }
+
+    CandleShape (double open, double high, double low, double close)
+        : body(std::fabs(close - open)),
+          upper(high - (close >= open ? close : open)),
+          lower((close >= open ? open : close) - low),
+          range(high - low),
+          color(close >= open ? 1 : -1) {
+    }
+
+    /// The range a setting averages, TA-lib's TA_CANDLERANGE.
+    double of (TA_RangeType type) const {
+        switch (type) {
+        case TA_RangeType_RealBody: return body;
+        case TA_RangeType_HighLow: return range;
+        default: return upper + lower;
+        }
+    }
+};
+
+/// Maximal number of running totals of a pattern.
+static const int CANDLE_TOTALS = 9;
+
+/// The running totals of a pattern and the size of the pattern.
+/**
+ * A total averages the ranges of a setting for the candle offset bars
+ * before the current one.  The lookback of a pattern is the longest period
+ * of its settings plus extra.
+ */
+struct CandleRule {
+    CandlePattern pattern;
+    int extra;
+    int count;
+    struct {
+        TA_CandleSettingType setting;
+        int offset;
+    } totals[CANDLE_TOTALS];
+};
+
+/// Rule of a pattern, transcribed from TA-lib's CDL functions.
+static inline const CandleRule &candleRule (CandlePattern pattern)
+{
+    static const CandleRule rules[CANDLE_PATTERNS] = {
+        { CANDLE_2CROWS, 2, 1, { { TA_BodyLong, 2 } } },
+        { CANDLE_3BLACKCROWS, 3, 3, { { TA_ShadowVeryShort, 2 }, { TA_ShadowVeryShort, 1 }, { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_3INSIDE, 2, 2, { { TA_BodyLong, 2 }, { TA_BodyShort, 1 } } },
+        { CANDLE_3LINESTRIKE, 3, 2, { { TA_Near, 3 }, { TA_Near, 2 } } },
+        { CANDLE_3OUTSIDE, 3, 0, { } },
+        { CANDLE_3STARSINSOUTH, 2, 5, { { TA_BodyLong, 2 }, { TA_ShadowLong, 2 }, { TA_ShadowVeryShort, 1 },
+                                    { TA_ShadowVeryShort, 0 }, { TA_BodyShort, 0 } } },
+        { CANDLE_3WHITESOLDIERS, 2, 8, { { TA_ShadowVeryShort, 2 }, { TA_ShadowVeryShort, 1 }, { TA_ShadowVeryShort, 0 },
+                                     { TA_Near, 2 }, { TA_Near, 1 }, { TA_Far, 2 }, { TA_Far, 1 },
+                                     { TA_BodyShort, 0 } } },
+        { CANDLE_ABANDONEDBABY, 2, 3, { { TA_BodyLong, 2 }, { TA_BodyDoji, 1 }, { TA_BodyShort, 0 } } },
+        { CANDLE_ADVANCEBLOCK, 2, 9, { { TA_ShadowShort, 2 }, { TA_ShadowShort, 1 }, { TA_ShadowShort, 0 },
+                                   { TA_ShadowLong, 0 }, { TA_Near, 2 }, { TA_Near, 1 }, { TA_Far, 2 },
+                                   { TA_Far, 1 }, { TA_BodyLong, 2 } } },
+        { CANDLE_BELTHOLD, 0, 2, { { TA_BodyLong, 0 }, { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_BREAKAWAY, 4, 1, { { TA_BodyLong, 4 } } },
+        { CANDLE_CLOSINGMARUBOZU, 0, 2, { { TA_BodyLong, 0 }, { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_CONCEALBABYSWALL, 3, 3, { { TA_ShadowVeryShort, 3 }, { TA_ShadowVeryShort, 2 }, { TA_ShadowVeryShort, 1 } } },
+        { CANDLE_COUNTERATTACK, 1, 3, { { TA_BodyLong, 1 }, { TA_BodyLong, 0 }, { TA_Equal, 1 } } },
+        { CANDLE_DARKCLOUDCOVER, 1, 1, { { TA_BodyLong, 1 } } },
+        { CANDLE_DOJI, 0, 1, { { TA_BodyDoji, 0 } } },
+        { CANDLE_DOJISTAR, 1, 2, { { TA_BodyLong, 1 }, { TA_BodyDoji, 0 } } },
+        { CANDLE_DRAGONFLYDOJI, 0, 2, { { TA_BodyDoji, 0 }, { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_ENGULFING, 2, 0, { } },
+        { CANDLE_EVENINGDOJISTAR, 2, 3, { { TA_BodyLong, 2 }, { TA_BodyDoji, 1 }, { TA_BodyShort, 0 } } },
+        { CANDLE_EVENINGSTAR, 2, 3, { { TA_BodyLong, 2 }, { TA_BodyShort, 1 }, { TA_BodyShort, 0 } } },
+        { CANDLE_GAPSIDESIDEWHITE, 2, 2, { { TA_Near, 1 }, { TA_Equal, 1 } } },
+        { CANDLE_GRAVESTONEDOJI, 0, 2, { { TA_BodyDoji, 0 }, { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_HAMMER, 1, 4, { { TA_BodyShort, 0 }, { TA_ShadowLong, 0 }, { TA_ShadowVeryShort, 0 }, { TA_Near, 1 } } },
+        { CANDLE_HANGINGMAN, 1, 4, { { TA_BodyShort, 0 }, { TA_ShadowLong, 0 }, { TA_ShadowVeryShort, 0 }, { TA_Near, 1 } } },
+        { CANDLE_HARAMI, 1, 2, { { TA_BodyLong, 1 }, { TA_BodyShort, 0 } } },
+        { CANDLE_HARAMICROSS, 1, 2, { { TA_BodyLong, 1 }, { TA_BodyDoji, 0 } } },
+        { CANDLE_HIGHWAVE, 0, 2, { { TA_BodyShort, 0 }, { TA_ShadowVeryLong, 0 } } },
+        { CANDLE_HIKKAKE, 5, 0, { } },
+        { CANDLE_HIKKAKEMOD, 5, 1, { { TA_Near, 2 } } },
+        { CANDLE_HOMINGPIGEON, 1, 2, { { TA_BodyLong, 1 }, { TA_BodyShort, 0 } } },
+        { CANDLE_IDENTICAL3CROWS, 2, 5, { { TA_ShadowVeryShort, 2 }, { TA_ShadowVeryShort, 1 }, { TA_ShadowVeryShort, 0 },
+                                      { TA_Equal, 2 }, { TA_Equal, 1 } } },
+        { CANDLE_INNECK, 1, 2, { { TA_BodyLong, 1 }, { TA_Equal, 1 } } },
+        { CANDLE_INVERTEDHAMMER, 1, 3, { { TA_BodyShort, 0 }, { TA_ShadowLong, 0 }, { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_KICKING, 1, 4, { { TA_BodyLong, 1 }, { TA_BodyLong, 0 }, { TA_ShadowVeryShort, 1 },
+                              { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_KICKINGBYLENGTH, 1, 4, { { TA_BodyLong, 1 }, { TA_BodyLong, 0 }, { TA_ShadowVeryShort, 1 },
+                                      { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_LADDERBOTTOM, 4, 1, { { TA_ShadowVeryShort, 1 } } },
+        { CANDLE_LONGLEGGEDDOJI, 0, 2, { { TA_BodyDoji, 0 }, { TA_ShadowLong, 0 } } },
+        { CANDLE_LONGLINE, 0, 2, { { TA_BodyLong, 0 }, { TA_ShadowShort, 0 } } },
+        { CANDLE_MARUBOZU, 0, 2, { { TA_BodyLong, 0 }, { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_MATCHINGLOW, 1, 1, { { TA_Equal, 1 } } },
+        { CANDLE_MATHOLD, 4, 4, { { TA_BodyLong, 4 }, { TA_BodyShort, 3 }, { TA_BodyShort, 2 }, { TA_BodyShort, 1 } } },
+        { CANDLE_MORNINGDOJISTAR, 2, 3, { { TA_BodyLong, 2 }, { TA_BodyDoji, 1 }, { TA_BodyShort, 0 } } },
+        { CANDLE_MORNINGSTAR, 2, 3, { { TA_BodyLong, 2 }, { TA_BodyShort, 1 }, { TA_BodyShort, 0 } } },
+        { CANDLE_ONNECK, 1, 2, { { TA_BodyLong, 1 }, { TA_Equal, 1 } } },
+        { CANDLE_PIERCING, 1, 2, { { TA_BodyLong, 1 }, { TA_BodyLong, 0 } } },
+        { CANDLE_RICKSHAWMAN, 0, 3, { { TA_BodyDoji, 0 }, { TA_ShadowLong, 0 }, { TA_Near, 0 } } },
+        { CANDLE_RISEFALL3METHODS, 4, 5, { { TA_BodyLong, 4 }, { TA_BodyShort, 3 }, { TA_BodyShort, 2 },
+                                       { TA_BodyShort, 1 }, { TA_BodyLong, 0 } } },
+        { CANDLE_SEPARATINGLINES, 1, 3, { { TA_ShadowVeryShort, 0 }, { TA_BodyLong, 0 }, { TA_Equal, 1 } } },
+        { CANDLE_SHOOTINGSTAR, 1, 3, { { TA_BodyShort, 0 }, { TA_ShadowLong, 0 }, { TA_ShadowVeryShort, 0 } } },
+        { CANDLE_SHORTLINE, 0, 2, { { TA_BodyShort, 0 }, { TA_ShadowShort, 0 } } },
+        { CANDLE_SPINNINGTOP, 0, 1, { { TA_BodyShort, 0 } } },
+        { CANDLE_STALLEDPATTERN, 2, 6, { { TA_BodyLong, 2 }, { TA_BodyLong, 1 }, { TA_BodyShort, 0 },
+                                     { TA_ShadowVeryShort, 1 }, { TA_Near, 2 }, { TA_Near, 1 } } },
+        { CANDLE_STICKSANDWICH, 2, 1, { { TA_Equal, 2 } } },
+        { CANDLE_TAKURI, 0, 3, { { TA_BodyDoji, 0 }, { TA_ShadowVeryShort, 0 }, { TA_ShadowVeryLong, 0 } } },
+        { CANDLE_TASUKIGAP, 2, 1, { { TA_Near, 1 } } },
+        { CANDLE_THRUSTING, 1, 2, { { TA_BodyLong, 1 }, { TA_Equal, 1 } } },
+        { CANDLE_TRISTAR, 2, 1, { { TA_BodyDoji, 2 } } },
+        { CANDLE_UNIQUE3RIVER, 2, 2, { { TA_BodyLong, 2 }, { TA_BodyShort, 0 } } },
+        { CANDLE_UPSIDEGAP2CROWS, 2, 2, { { TA_BodyLong, 2 }, { TA_BodyShort, 1 } } },
+        { CANDLE_XSIDEGAP3METHODS, 2, 0, { } }
+    };
+    const CandleRule &rule = rules[pattern];
+    verify(rule.pattern == pattern);
+    return rule;
+}
+
+/// Lookback of a pattern, as TA-lib's.
+static inline TA_Integer candleLookback (CandlePattern pattern, const CandleSetting *settings)
+{
+    const CandleRule &rule = candleRule(pattern);
+    TA_Integer period = pattern == CANDLE_HIKKAKEMOD ? 1 : 0;
+    for (int j = 0; j < rule.count; ++j) {
+        period = std::max(period, settings[rule.totals[j].setting].period);
+    }
+    return period + rule.extra;
+}
+
+/// Element from which a pattern keeps its totals and state.
+/**
+ * TA-lib starts the hikkake patterns three candles before their lookback,
+ * to find the patterns a confirmation within the output refers to.
+ */
+static inline TA_Integer candleStart (CandlePattern pattern, const CandleSetting *settings)
+{
+    TA_Integer lookback = candleLookback(pattern, settings);
+    return pattern == CANDLE_HIKKAKE || pattern == CANDLE_HIKKAKEMOD ? lookback - 3 : lookback;
+}
+
+/// Candlestick pattern kernel.
+/**
+ * Finds the patterns in patterns with the candle settings given, one per
+ * TA_CandleSettingType, and writes for every element i: in mask[i] the
+ * patterns found, in bearish[i] those with a negative strength and in
+ * strong[i] those with a strength of 200 or -200, the confirmed hikkakes.
+ * Patterns are not found before their lookback.
+ *
+ * The tests are transcribed from TA-lib's CDL functions, with macros named
+ * after TA-lib's.  As in TA-lib, each pattern averages ranges over running
+ * totals that start at the pattern's lookback and then slide; a total is
+ * shared by the patterns whose totals have the same setting, offset and
+ * start, which TA-lib computes in the same order.  The results are
+ * therefore the same as TA-lib's.
+ *
+ * The kernel is all branches and does not vectorize, so it is not run
+ * through dispatch().
+ */
+template <typename I>
+class Candlesticks
+{
+    struct Total {
+        TA_CandleSettingType setting;
+        int offset;
+        TA_Integer start;
+        double sum;
+    };
+
+    I open, high, low, close;
+    TA_Integer n;
+    CandleMask patterns;
+    const CandleSetting *settings;
+    CandleMask *mask, *bearish, *strong;
+
+    // Shapes of the last candles, as far back as the oldest a total drops.
+    std::vector<CandleShape> ring;
+    std::vector<Total> totals;
+    // Index in totals of each pattern, setting and offset.
+    std::vector<int> slots;
+    TA_Integer lookback[CANDLE_PATTERNS], start[CANDLE_PATTERNS];
+    // Last pattern and its result of CDLHIKKAKE and CDLHIKKAKEMOD.
+    TA_Integer hikkakeIndex[2];
+    int hikkakeResult[2];
+
+    static const int OFFSETS = 5;
+
+    const CandleShape &shape (TA_Integer i) const {
+        return ring[i % ring.size()];
+    }
+
+    int &slot (CandlePattern pattern, TA_CandleSettingType setting, int offset) {
+        return slots[(pattern * TA_AllCandleSettings + setting) * OFFSETS + offset];
+    }
+
+    /// TA-lib's TA_CANDLEAVERAGE.
+    double average (CandlePattern pattern, TA_CandleSettingType setting, int offset, TA_Integer i) {
+        const CandleSetting &s = settings[setting];
+        double a = s.period != 0 ? totals[slot(pattern, setting, offset)].sum / s.period
+                                 : shape(i - offset).of(s.range);
+        return s.factor * a / (s.range == TA_RangeType_Shadows ? 2.0 : 1.0);
+    }
+
+    bool bodyGapUp (TA_Integer i2, TA_Integer i1) const {
+        return std::min(double(open[i2]), double(close[i2])) > std::max(double(open[i1]), double(close[i1]));
+    }
+
+    bool bodyGapDown (TA_Integer i2, TA_Integer i1) const {
+        return std::max(double(open[i2]), double(close[i2])) < std::min(double(open[i1]), double(close[i1]));
+    }
+
+    /// Result of a hikkake pattern, with its confirmation.
+    int hikkake (int k, TA_Integer i, bool found) {
+        TA_Integer &index = hikkakeIndex[k];
+        int &result = hikkakeResult[k];
+        if (found) {
+            result = 100 * (high[i] < high[i - 1] ? 1 : -1);
+            index = i;
+            return result;
+        }
+        if (i <= index + 3 && ((result > 0 && close[i] > high[index - 1])
+                               || (result < 0 && close[i] < low[index - 1]))) {
+            index = 0;
+            return result + 100 * (result > 0 ? 1 : -1);
+        }
+        return 0;
+    }
+
+#define TAPP_O(_k) double(open[i - (_k)])
+#define TAPP_H(_k) double(high[i - (_k)])
+#define TAPP_L(_k) double(low[i - (_k)])
+#define TAPP_C(_k) double(close[i - (_k)])
+#define TAPP_REALBODY(_k) shape(i - (_k)).body
+#define TAPP_UPPERSHADOW(_k) shape(i - (_k)).upper
+#define TAPP_LOWERSHADOW(_k) shape(i - (_k)).lower
+#define TAPP_HIGHLOWRANGE(_k) shape(i - (_k)).range
+#define TAPP_COLOR(_k) shape(i - (_k)).color
+#define TAPP_AVERAGE(_setting, _k) average(pattern, TA_##_setting, _k, i)
+#define TAPP_BODYGAPUP(_k2, _k1) bodyGapUp(i - (_k2), i - (_k1))
+#define TAPP_BODYGAPDOWN(_k2, _k1) bodyGapDown(i - (_k2), i - (_k1))
+#define TAPP_GAPUP(_k2, _k1) (TAPP_L(_k2) > TAPP_H(_k1))
+#define TAPP_GAPDOWN(_k2, _k1) (TAPP_H(_k2) < TAPP_L(_k1))
+#define TAPP_BODYMIN(_k) std::min(TAPP_O(_k), TAPP_C(_k))
+#define TAPP_BODYMAX(_k) std::max(TAPP_O(_k), TAPP_C(_k))
+
+    /// Strength of a pattern at element i, TA-lib's output.
+    int find (CandlePattern pattern, TA_Integer i) {
+        switch (pattern) {
+        case CANDLE_2CROWS:
+            return TAPP_COLOR(2) == 1 && TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) &&
+                   TAPP_COLOR(1) == -1 && TAPP_BODYGAPUP(1, 2) &&
+                   TAPP_COLOR(0) == -1 && TAPP_O(0) < TAPP_O(1) && TAPP_O(0) > TAPP_C(1) &&
+                   TAPP_C(0) > TAPP_O(2) && TAPP_C(0) < TAPP_C(2) ? -100 : 0;
+        case CANDLE_3BLACKCROWS:
+            return TAPP_COLOR(3) == 1 &&
+                   TAPP_COLOR(2) == -1 && TAPP_LOWERSHADOW(2) < TAPP_AVERAGE(ShadowVeryShort, 2) &&
+                   TAPP_COLOR(1) == -1 && TAPP_LOWERSHADOW(1) < TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                   TAPP_COLOR(0) == -1 && TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_O(1) < TAPP_O(2) && TAPP_O(1) > TAPP_C(2) &&
+                   TAPP_O(0) < TAPP_O(1) && TAPP_O(0) > TAPP_C(1) &&
+                   TAPP_H(3) > TAPP_C(2) && TAPP_C(2) > TAPP_C(1) && TAPP_C(1) > TAPP_C(0) ? -100 : 0;
+        case CANDLE_3INSIDE:
+            return TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) &&
+                   TAPP_REALBODY(1) <= TAPP_AVERAGE(BodyShort, 1) &&
+                   TAPP_BODYMAX(1) < TAPP_BODYMAX(2) && TAPP_BODYMIN(1) > TAPP_BODYMIN(2) &&
+                   ((TAPP_COLOR(2) == 1 && TAPP_COLOR(0) == -1 && TAPP_C(0) < TAPP_O(2)) ||
+                    (TAPP_COLOR(2) == -1 && TAPP_COLOR(0) == 1 && TAPP_C(0) > TAPP_O(2)))
+                   ? -TAPP_COLOR(2) * 100 : 0;
+        case CANDLE_3LINESTRIKE:
+            return TAPP_COLOR(3) == TAPP_COLOR(2) && TAPP_COLOR(2) == TAPP_COLOR(1) &&
+                   TAPP_COLOR(0) == -TAPP_COLOR(1) &&
+                   TAPP_O(2) >= TAPP_BODYMIN(3) - TAPP_AVERAGE(Near, 3) &&
+                   TAPP_O(2) <= TAPP_BODYMAX(3) + TAPP_AVERAGE(Near, 3) &&
+                   TAPP_O(1) >= TAPP_BODYMIN(2) - TAPP_AVERAGE(Near, 2) &&
+                   TAPP_O(1) <= TAPP_BODYMAX(2) + TAPP_AVERAGE(Near, 2) &&
+                   ((TAPP_COLOR(1) == 1 && TAPP_C(1) > TAPP_C(2) && TAPP_C(2) > TAPP_C(3) &&
+                     TAPP_O(0) > TAPP_C(1) && TAPP_C(0) < TAPP_O(3)) ||
+                    (TAPP_COLOR(1) == -1 && TAPP_C(1) < TAPP_C(2) && TAPP_C(2) < TAPP_C(3) &&
+                     TAPP_O(0) < TAPP_C(1) && TAPP_C(0) > TAPP_O(3)))
+                   ? TAPP_COLOR(1) * 100 : 0;
+        case CANDLE_3OUTSIDE:
+            return (TAPP_COLOR(1) == 1 && TAPP_COLOR(2) == -1 &&
+                    TAPP_C(1) > TAPP_O(2) && TAPP_O(1) < TAPP_C(2) && TAPP_C(0) > TAPP_C(1)) ||
+                   (TAPP_COLOR(1) == -1 && TAPP_COLOR(2) == 1 &&
+                    TAPP_O(1) > TAPP_C(2) && TAPP_C(1) < TAPP_O(2) && TAPP_C(0) < TAPP_C(1))
+                   ? TAPP_COLOR(1) * 100 : 0;
+        case CANDLE_3STARSINSOUTH:
+            return TAPP_COLOR(2) == -1 && TAPP_COLOR(1) == -1 && TAPP_COLOR(0) == -1 &&
+                   TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) &&
+                   TAPP_LOWERSHADOW(2) > TAPP_AVERAGE(ShadowLong, 2) &&
+                   TAPP_REALBODY(1) < TAPP_REALBODY(2) &&
+                   TAPP_O(1) > TAPP_C(2) && TAPP_O(1) <= TAPP_H(2) &&
+                   TAPP_L(1) < TAPP_C(2) && TAPP_L(1) >= TAPP_L(2) &&
+                   TAPP_LOWERSHADOW(1) > TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                   TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_L(0) > TAPP_L(1) && TAPP_H(0) < TAPP_H(1) ? 100 : 0;
+        case CANDLE_3WHITESOLDIERS:
+            return TAPP_COLOR(2) == 1 && TAPP_UPPERSHADOW(2) < TAPP_AVERAGE(ShadowVeryShort, 2) &&
+                   TAPP_COLOR(1) == 1 && TAPP_UPPERSHADOW(1) < TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                   TAPP_COLOR(0) == 1 && TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_C(0) > TAPP_C(1) && TAPP_C(1) > TAPP_C(2) &&
+                   TAPP_O(1) > TAPP_O(2) && TAPP_O(1) <= TAPP_C(2) + TAPP_AVERAGE(Near, 2) &&
+                   TAPP_O(0) > TAPP_O(1) && TAPP_O(0) <= TAPP_C(1) + TAPP_AVERAGE(Near, 1) &&
+                   TAPP_REALBODY(1) > TAPP_REALBODY(2) - TAPP_AVERAGE(Far, 2) &&
+                   TAPP_REALBODY(0) > TAPP_REALBODY(1) - TAPP_AVERAGE(Far, 1) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyShort, 0) ? 100 : 0;
+        case CANDLE_ABANDONEDBABY:
+            return TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) &&
+                   TAPP_REALBODY(1) <= TAPP_AVERAGE(BodyDoji, 1) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyShort, 0) &&
+                   ((TAPP_COLOR(2) == 1 && TAPP_COLOR(0) == -1 &&
+                     TAPP_C(0) < TAPP_C(2) - TAPP_REALBODY(2) * 0.3 &&
+                     TAPP_GAPUP(1, 2) && TAPP_GAPDOWN(0, 1)) ||
+                    (TAPP_COLOR(2) == -1 && TAPP_COLOR(0) == 1 &&
+                     TAPP_C(0) > TAPP_C(2) + TAPP_REALBODY(2) * 0.3 &&
+                     TAPP_GAPDOWN(1, 2) && TAPP_GAPUP(0, 1)))
+                   ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_ADVANCEBLOCK:
+            return TAPP_COLOR(2) == 1 && TAPP_COLOR(1) == 1 && TAPP_COLOR(0) == 1 &&
+                   TAPP_C(0) > TAPP_C(1) && TAPP_C(1) > TAPP_C(2) &&
+                   TAPP_O(1) > TAPP_O(2) && TAPP_O(1) <= TAPP_C(2) + TAPP_AVERAGE(Near, 2) &&
+                   TAPP_O(0) > TAPP_O(1) && TAPP_O(0) <= TAPP_C(1) + TAPP_AVERAGE(Near, 1) &&
+                   TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) &&
+                   TAPP_UPPERSHADOW(2) < TAPP_AVERAGE(ShadowShort, 2) &&
+                   ((TAPP_REALBODY(1) < TAPP_REALBODY(2) - TAPP_AVERAGE(Far, 2) &&
+                     TAPP_REALBODY(0) < TAPP_REALBODY(1) + TAPP_AVERAGE(Near, 1)) ||
+                    (TAPP_REALBODY(0) < TAPP_REALBODY(1) - TAPP_AVERAGE(Far, 1)) ||
+                    (TAPP_REALBODY(0) < TAPP_REALBODY(1) && TAPP_REALBODY(1) < TAPP_REALBODY(2) &&
+                     (TAPP_UPPERSHADOW(0) > TAPP_AVERAGE(ShadowShort, 0) ||
+                      TAPP_UPPERSHADOW(1) > TAPP_AVERAGE(ShadowShort, 1))) ||
+                    (TAPP_REALBODY(0) < TAPP_REALBODY(1) &&
+                     TAPP_UPPERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0)))
+                   ? -100 : 0;
+        case CANDLE_BELTHOLD:
+            return TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                   ((TAPP_COLOR(0) == 1 && TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0)) ||
+                    (TAPP_COLOR(0) == -1 && TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0)))
+                   ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_BREAKAWAY:
+            return TAPP_REALBODY(4) > TAPP_AVERAGE(BodyLong, 4) &&
+                   TAPP_COLOR(4) == TAPP_COLOR(3) && TAPP_COLOR(3) == TAPP_COLOR(1) &&
+                   TAPP_COLOR(1) == -TAPP_COLOR(0) &&
+                   ((TAPP_COLOR(4) == -1 && TAPP_BODYGAPDOWN(3, 4) &&
+                     TAPP_H(2) < TAPP_H(3) && TAPP_L(2) < TAPP_L(3) &&
+                     TAPP_H(1) < TAPP_H(2) && TAPP_L(1) < TAPP_L(2) &&
+                     TAPP_C(0) > TAPP_O(3) && TAPP_C(0) < TAPP_C(4)) ||
+                    (TAPP_COLOR(4) == 1 && TAPP_BODYGAPUP(3, 4) &&
+                     TAPP_H(2) > TAPP_H(3) && TAPP_L(2) > TAPP_L(3) &&
+                     TAPP_H(1) > TAPP_H(2) && TAPP_L(1) > TAPP_L(2) &&
+                     TAPP_C(0) < TAPP_O(3) && TAPP_C(0) > TAPP_C(4)))
+                   ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_CLOSINGMARUBOZU:
+            return TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                   ((TAPP_COLOR(0) == 1 && TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0)) ||
+                    (TAPP_COLOR(0) == -1 && TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0)))
+                   ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_CONCEALBABYSWALL:
+            return TAPP_COLOR(3) == -1 && TAPP_COLOR(2) == -1 && TAPP_COLOR(1) == -1 && TAPP_COLOR(0) == -1 &&
+                   TAPP_LOWERSHADOW(3) < TAPP_AVERAGE(ShadowVeryShort, 3) &&
+                   TAPP_UPPERSHADOW(3) < TAPP_AVERAGE(ShadowVeryShort, 3) &&
+                   TAPP_LOWERSHADOW(2) < TAPP_AVERAGE(ShadowVeryShort, 2) &&
+                   TAPP_UPPERSHADOW(2) < TAPP_AVERAGE(ShadowVeryShort, 2) &&
+                   TAPP_BODYGAPDOWN(1, 2) &&
+                   TAPP_UPPERSHADOW(1) > TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                   TAPP_H(1) > TAPP_C(2) &&
+                   TAPP_H(0) > TAPP_H(1) && TAPP_L(0) < TAPP_L(1) ? 100 : 0;
+        case CANDLE_COUNTERATTACK:
+            return TAPP_COLOR(1) == -TAPP_COLOR(0) &&
+                   TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                   TAPP_C(0) <= TAPP_C(1) + TAPP_AVERAGE(Equal, 1) &&
+                   TAPP_C(0) >= TAPP_C(1) - TAPP_AVERAGE(Equal, 1) ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_DARKCLOUDCOVER:
+            return TAPP_COLOR(1) == 1 && TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_COLOR(0) == -1 && TAPP_O(0) > TAPP_H(1) && TAPP_C(0) > TAPP_O(1) &&
+                   TAPP_C(0) < TAPP_C(1) - TAPP_REALBODY(1) * 0.5 ? -100 : 0;
+        case CANDLE_DOJI:
+            return TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 0) ? 100 : 0;
+        case CANDLE_DOJISTAR:
+            return TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 0) &&
+                   ((TAPP_COLOR(1) == 1 && TAPP_BODYGAPUP(0, 1)) ||
+                    (TAPP_COLOR(1) == -1 && TAPP_BODYGAPDOWN(0, 1))) ? -TAPP_COLOR(1) * 100 : 0;
+        case CANDLE_DRAGONFLYDOJI:
+            return TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 0) &&
+                   TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_LOWERSHADOW(0) > TAPP_AVERAGE(ShadowVeryShort, 0) ? 100 : 0;
+        case CANDLE_ENGULFING:
+            return (TAPP_COLOR(0) == 1 && TAPP_COLOR(1) == -1 &&
+                    TAPP_C(0) > TAPP_O(1) && TAPP_O(0) < TAPP_C(1)) ||
+                   (TAPP_COLOR(0) == -1 && TAPP_COLOR(1) == 1 &&
+                    TAPP_O(0) > TAPP_C(1) && TAPP_C(0) < TAPP_O(1)) ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_EVENINGDOJISTAR:
+            return TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) && TAPP_COLOR(2) == 1 &&
+                   TAPP_REALBODY(1) <= TAPP_AVERAGE(BodyDoji, 1) && TAPP_BODYGAPUP(1, 2) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyShort, 0) && TAPP_COLOR(0) == -1 &&
+                   TAPP_C(0) < TAPP_C(2) - TAPP_REALBODY(2) * 0.3 ? -100 : 0;
+        case CANDLE_EVENINGSTAR:
+            return TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) && TAPP_COLOR(2) == 1 &&
+                   TAPP_REALBODY(1) <= TAPP_AVERAGE(BodyShort, 1) && TAPP_BODYGAPUP(1, 2) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyShort, 0) && TAPP_COLOR(0) == -1 &&
+                   TAPP_C(0) < TAPP_C(2) - TAPP_REALBODY(2) * 0.3 ? -100 : 0;
+        case CANDLE_GAPSIDESIDEWHITE:
+            return ((TAPP_BODYGAPUP(1, 2) && TAPP_BODYGAPUP(0, 2)) ||
+                    (TAPP_BODYGAPDOWN(1, 2) && TAPP_BODYGAPDOWN(0, 2))) &&
+                   TAPP_COLOR(1) == 1 && TAPP_COLOR(0) == 1 &&
+                   TAPP_REALBODY(0) >= TAPP_REALBODY(1) - TAPP_AVERAGE(Near, 1) &&
+                   TAPP_REALBODY(0) <= TAPP_REALBODY(1) + TAPP_AVERAGE(Near, 1) &&
+                   TAPP_O(0) >= TAPP_O(1) - TAPP_AVERAGE(Equal, 1) &&
+                   TAPP_O(0) <= TAPP_O(1) + TAPP_AVERAGE(Equal, 1)
+                   ? (TAPP_BODYGAPUP(1, 2) ? 100 : -100) : 0;
+        case CANDLE_GRAVESTONEDOJI:
+            return TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 0) &&
+                   TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_UPPERSHADOW(0) > TAPP_AVERAGE(ShadowVeryShort, 0) ? 100 : 0;
+        case CANDLE_HAMMER:
+            return TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_LOWERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0) &&
+                   TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_BODYMIN(0) <= TAPP_L(1) + TAPP_AVERAGE(Near, 1) ? 100 : 0;
+        case CANDLE_HANGINGMAN:
+            return TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_LOWERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0) &&
+                   TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_BODYMIN(0) >= TAPP_H(1) - TAPP_AVERAGE(Near, 1) ? -100 : 0;
+        case CANDLE_HARAMI:
+            return TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_BODYMAX(0) < TAPP_BODYMAX(1) && TAPP_BODYMIN(0) > TAPP_BODYMIN(1)
+                   ? -TAPP_COLOR(1) * 100 : 0;
+        case CANDLE_HARAMICROSS:
+            return TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 0) &&
+                   TAPP_BODYMAX(0) < TAPP_BODYMAX(1) && TAPP_BODYMIN(0) > TAPP_BODYMIN(1)
+                   ? -TAPP_COLOR(1) * 100 : 0;
+        case CANDLE_HIGHWAVE:
+            return TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_UPPERSHADOW(0) > TAPP_AVERAGE(ShadowVeryLong, 0) &&
+                   TAPP_LOWERSHADOW(0) > TAPP_AVERAGE(ShadowVeryLong, 0) ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_HIKKAKE:
+            return hikkake(0, i, TAPP_H(1) < TAPP_H(2) && TAPP_L(1) > TAPP_L(2) &&
+                           ((TAPP_H(0) < TAPP_H(1) && TAPP_L(0) < TAPP_L(1)) ||
+                            (TAPP_H(0) > TAPP_H(1) && TAPP_L(0) > TAPP_L(1))));
+        case CANDLE_HIKKAKEMOD:
+            return hikkake(1, i, TAPP_H(2) < TAPP_H(3) && TAPP_L(2) > TAPP_L(3) &&
+                           TAPP_H(1) < TAPP_H(2) && TAPP_L(1) > TAPP_L(2) &&
+                           ((TAPP_H(0) < TAPP_H(1) && TAPP_L(0) < TAPP_L(1) &&
+                             TAPP_C(2) <= TAPP_L(2) + TAPP_AVERAGE(Near, 2)) ||
+                            (TAPP_H(0) > TAPP_H(1) && TAPP_L(0) > TAPP_L(1) &&
+                             TAPP_C(2) >= TAPP_H(2) - TAPP_AVERAGE(Near, 2))));
+        case CANDLE_HOMINGPIGEON:
+            return TAPP_COLOR(1) == -1 && TAPP_COLOR(0) == -1 &&
+                   TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_O(0) < TAPP_O(1) && TAPP_C(0) > TAPP_C(1) ? 100 : 0;
+        case CANDLE_IDENTICAL3CROWS:
+            return TAPP_COLOR(2) == -1 && TAPP_LOWERSHADOW(2) < TAPP_AVERAGE(ShadowVeryShort, 2) &&
+                   TAPP_COLOR(1) == -1 && TAPP_LOWERSHADOW(1) < TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                   TAPP_COLOR(0) == -1 && TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_C(2) > TAPP_C(1) && TAPP_C(1) > TAPP_C(0) &&
+                   TAPP_O(1) <= TAPP_C(2) + TAPP_AVERAGE(Equal, 2) &&
+                   TAPP_O(1) >= TAPP_C(2) - TAPP_AVERAGE(Equal, 2) &&
+                   TAPP_O(0) <= TAPP_C(1) + TAPP_AVERAGE(Equal, 1) &&
+                   TAPP_O(0) >= TAPP_C(1) - TAPP_AVERAGE(Equal, 1) ? -100 : 0;
+        case CANDLE_INNECK:
+            return TAPP_COLOR(1) == -1 && TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_COLOR(0) == 1 && TAPP_O(0) < TAPP_L(1) &&
+                   TAPP_C(0) <= TAPP_C(1) + TAPP_AVERAGE(Equal, 1) && TAPP_C(0) >= TAPP_C(1) ? -100 : 0;
+        case CANDLE_INVERTEDHAMMER:
+            return TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_UPPERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0) &&
+                   TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_BODYGAPDOWN(0, 1) ? 100 : 0;
+        case CANDLE_KICKING:
+        case CANDLE_KICKINGBYLENGTH:
+            if (!(TAPP_COLOR(1) == -TAPP_COLOR(0) &&
+                  TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                  TAPP_UPPERSHADOW(1) < TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                  TAPP_LOWERSHADOW(1) < TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                  TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                  TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                  TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                  ((TAPP_COLOR(1) == -1 && TAPP_GAPUP(0, 1)) ||
+                   (TAPP_COLOR(1) == 1 && TAPP_GAPDOWN(0, 1))))) return 0;
+            if (pattern == CANDLE_KICKING) return TAPP_COLOR(0) * 100;
+            return (TAPP_REALBODY(0) > TAPP_REALBODY(1) ? TAPP_COLOR(0) : TAPP_COLOR(1)) * 100;
+        case CANDLE_LADDERBOTTOM:
+            return TAPP_COLOR(4) == -1 && TAPP_COLOR(3) == -1 && TAPP_COLOR(2) == -1 &&
+                   TAPP_O(4) > TAPP_O(3) && TAPP_O(3) > TAPP_O(2) &&
+                   TAPP_C(4) > TAPP_C(3) && TAPP_C(3) > TAPP_C(2) &&
+                   TAPP_COLOR(1) == -1 && TAPP_UPPERSHADOW(1) > TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                   TAPP_COLOR(0) == 1 && TAPP_O(0) > TAPP_O(1) && TAPP_C(0) > TAPP_H(1) ? 100 : 0;
+        case CANDLE_LONGLEGGEDDOJI:
+            return TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 0) &&
+                   (TAPP_LOWERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0) ||
+                    TAPP_UPPERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0)) ? 100 : 0;
+        case CANDLE_LONGLINE:
+            return TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                   TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowShort, 0) &&
+                   TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowShort, 0) ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_MARUBOZU:
+            return TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                   TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_MATCHINGLOW:
+            return TAPP_COLOR(1) == -1 && TAPP_COLOR(0) == -1 &&
+                   TAPP_C(0) <= TAPP_C(1) + TAPP_AVERAGE(Equal, 1) &&
+                   TAPP_C(0) >= TAPP_C(1) - TAPP_AVERAGE(Equal, 1) ? 100 : 0;
+        case CANDLE_MATHOLD:
+            return TAPP_REALBODY(4) > TAPP_AVERAGE(BodyLong, 4) &&
+                   TAPP_REALBODY(3) < TAPP_AVERAGE(BodyShort, 3) &&
+                   TAPP_REALBODY(2) < TAPP_AVERAGE(BodyShort, 2) &&
+                   TAPP_REALBODY(1) < TAPP_AVERAGE(BodyShort, 1) &&
+                   TAPP_COLOR(4) == 1 && TAPP_COLOR(3) == -1 && TAPP_COLOR(0) == 1 &&
+                   TAPP_BODYGAPUP(3, 4) &&
+                   TAPP_BODYMIN(2) < TAPP_C(4) && TAPP_BODYMIN(1) < TAPP_C(4) &&
+                   TAPP_BODYMIN(2) > TAPP_C(4) - TAPP_REALBODY(4) * 0.5 &&
+                   TAPP_BODYMIN(1) > TAPP_C(4) - TAPP_REALBODY(4) * 0.5 &&
+                   TAPP_BODYMAX(2) < TAPP_O(3) && TAPP_BODYMAX(1) < TAPP_BODYMAX(2) &&
+                   TAPP_O(0) > TAPP_C(1) &&
+                   TAPP_C(0) > std::max(std::max(TAPP_H(3), TAPP_H(2)), TAPP_H(1)) ? 100 : 0;
+        case CANDLE_MORNINGDOJISTAR:
+            return TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) && TAPP_COLOR(2) == -1 &&
+                   TAPP_REALBODY(1) <= TAPP_AVERAGE(BodyDoji, 1) && TAPP_BODYGAPDOWN(1, 2) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyShort, 0) && TAPP_COLOR(0) == 1 &&
+                   TAPP_C(0) > TAPP_C(2) + TAPP_REALBODY(2) * 0.3 ? 100 : 0;
+        case CANDLE_MORNINGSTAR:
+            return TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) && TAPP_COLOR(2) == -1 &&
+                   TAPP_REALBODY(1) <= TAPP_AVERAGE(BodyShort, 1) && TAPP_BODYGAPDOWN(1, 2) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyShort, 0) && TAPP_COLOR(0) == 1 &&
+                   TAPP_C(0) > TAPP_C(2) + TAPP_REALBODY(2) * 0.3 ? 100 : 0;
+        case CANDLE_ONNECK:
+            return TAPP_COLOR(1) == -1 && TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_COLOR(0) == 1 && TAPP_O(0) < TAPP_L(1) &&
+                   TAPP_C(0) <= TAPP_L(1) + TAPP_AVERAGE(Equal, 1) &&
+                   TAPP_C(0) >= TAPP_L(1) - TAPP_AVERAGE(Equal, 1) ? -100 : 0;
+        case CANDLE_PIERCING:
+            return TAPP_COLOR(1) == -1 && TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_COLOR(0) == 1 && TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                   TAPP_O(0) < TAPP_L(1) && TAPP_C(0) < TAPP_O(1) &&
+                   TAPP_C(0) > TAPP_C(1) + TAPP_REALBODY(1) * 0.5 ? 100 : 0;
+        case CANDLE_RICKSHAWMAN:
+            return TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 0) &&
+                   TAPP_LOWERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0) &&
+                   TAPP_UPPERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0) &&
+                   TAPP_BODYMIN(0) <= TAPP_L(0) + TAPP_HIGHLOWRANGE(0) / 2 + TAPP_AVERAGE(Near, 0) &&
+                   TAPP_BODYMAX(0) >= TAPP_L(0) + TAPP_HIGHLOWRANGE(0) / 2 - TAPP_AVERAGE(Near, 0) ? 100 : 0;
+        case CANDLE_RISEFALL3METHODS:
+            return TAPP_REALBODY(4) > TAPP_AVERAGE(BodyLong, 4) &&
+                   TAPP_REALBODY(3) < TAPP_AVERAGE(BodyShort, 3) &&
+                   TAPP_REALBODY(2) < TAPP_AVERAGE(BodyShort, 2) &&
+                   TAPP_REALBODY(1) < TAPP_AVERAGE(BodyShort, 1) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                   TAPP_COLOR(4) == -TAPP_COLOR(3) && TAPP_COLOR(3) == TAPP_COLOR(2) &&
+                   TAPP_COLOR(2) == TAPP_COLOR(1) && TAPP_COLOR(1) == -TAPP_COLOR(0) &&
+                   TAPP_BODYMIN(3) < TAPP_H(4) && TAPP_BODYMAX(3) > TAPP_L(4) &&
+                   TAPP_BODYMIN(2) < TAPP_H(4) && TAPP_BODYMAX(2) > TAPP_L(4) &&
+                   TAPP_BODYMIN(1) < TAPP_H(4) && TAPP_BODYMAX(1) > TAPP_L(4) &&
+                   TAPP_C(2) * TAPP_COLOR(4) < TAPP_C(3) * TAPP_COLOR(4) &&
+                   TAPP_C(1) * TAPP_COLOR(4) < TAPP_C(2) * TAPP_COLOR(4) &&
+                   TAPP_O(0) * TAPP_COLOR(4) > TAPP_C(1) * TAPP_COLOR(4) &&
+                   TAPP_C(0) * TAPP_COLOR(4) > TAPP_C(4) * TAPP_COLOR(4) ? 100 * TAPP_COLOR(4) : 0;
+        case CANDLE_SEPARATINGLINES:
+            return TAPP_COLOR(1) == -TAPP_COLOR(0) &&
+                   TAPP_O(0) <= TAPP_O(1) + TAPP_AVERAGE(Equal, 1) &&
+                   TAPP_O(0) >= TAPP_O(1) - TAPP_AVERAGE(Equal, 1) &&
+                   TAPP_REALBODY(0) > TAPP_AVERAGE(BodyLong, 0) &&
+                   ((TAPP_COLOR(0) == 1 && TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0)) ||
+                    (TAPP_COLOR(0) == -1 && TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0)))
+                   ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_SHOOTINGSTAR:
+            return TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_UPPERSHADOW(0) > TAPP_AVERAGE(ShadowLong, 0) &&
+                   TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_BODYGAPUP(0, 1) ? -100 : 0;
+        case CANDLE_SHORTLINE:
+            return TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowShort, 0) &&
+                   TAPP_LOWERSHADOW(0) < TAPP_AVERAGE(ShadowShort, 0) ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_SPINNINGTOP:
+            return TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_UPPERSHADOW(0) > TAPP_REALBODY(0) &&
+                   TAPP_LOWERSHADOW(0) > TAPP_REALBODY(0) ? TAPP_COLOR(0) * 100 : 0;
+        case CANDLE_STALLEDPATTERN:
+            return TAPP_COLOR(2) == 1 && TAPP_COLOR(1) == 1 && TAPP_COLOR(0) == 1 &&
+                   TAPP_C(0) > TAPP_C(1) && TAPP_C(1) > TAPP_C(2) &&
+                   TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) &&
+                   TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_UPPERSHADOW(1) < TAPP_AVERAGE(ShadowVeryShort, 1) &&
+                   TAPP_O(1) > TAPP_O(2) && TAPP_O(1) <= TAPP_C(2) + TAPP_AVERAGE(Near, 2) &&
+                   TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) &&
+                   TAPP_O(0) >= TAPP_C(1) - TAPP_REALBODY(0) - TAPP_AVERAGE(Near, 1) ? -100 : 0;
+        case CANDLE_STICKSANDWICH:
+            return TAPP_COLOR(2) == -1 && TAPP_COLOR(1) == 1 && TAPP_COLOR(0) == -1 &&
+                   TAPP_L(1) > TAPP_C(2) &&
+                   TAPP_C(0) <= TAPP_C(2) + TAPP_AVERAGE(Equal, 2) &&
+                   TAPP_C(0) >= TAPP_C(2) - TAPP_AVERAGE(Equal, 2) ? 100 : 0;
+        case CANDLE_TAKURI:
+            return TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 0) &&
+                   TAPP_UPPERSHADOW(0) < TAPP_AVERAGE(ShadowVeryShort, 0) &&
+                   TAPP_LOWERSHADOW(0) > TAPP_AVERAGE(ShadowVeryLong, 0) ? 100 : 0;
+        case CANDLE_TASUKIGAP:
+            return (TAPP_BODYGAPUP(1, 2) && TAPP_COLOR(1) == 1 && TAPP_COLOR(0) == -1 &&
+                    TAPP_O(0) < TAPP_C(1) && TAPP_O(0) > TAPP_O(1) &&
+                    TAPP_C(0) < TAPP_O(1) && TAPP_C(0) > TAPP_BODYMAX(2) &&
+                    std::fabs(TAPP_REALBODY(1) - TAPP_REALBODY(0)) < TAPP_AVERAGE(Near, 1)) ||
+                   (TAPP_BODYGAPDOWN(1, 2) && TAPP_COLOR(1) == -1 && TAPP_COLOR(0) == 1 &&
+                    TAPP_O(0) < TAPP_O(1) && TAPP_O(0) > TAPP_C(1) &&
+                    TAPP_C(0) > TAPP_O(1) && TAPP_C(0) < TAPP_BODYMIN(2) &&
+                    std::fabs(TAPP_REALBODY(1) - TAPP_REALBODY(0)) < TAPP_AVERAGE(Near, 1))
+                   ? TAPP_COLOR(1) * 100 : 0;
+        case CANDLE_THRUSTING:
+            return TAPP_COLOR(1) == -1 && TAPP_REALBODY(1) > TAPP_AVERAGE(BodyLong, 1) &&
+                   TAPP_COLOR(0) == 1 && TAPP_O(0) < TAPP_L(1) &&
+                   TAPP_C(0) > TAPP_C(1) + TAPP_AVERAGE(Equal, 1) &&
+                   TAPP_C(0) <= TAPP_C(1) + TAPP_REALBODY(1) * 0.5 ? -100 : 0;
+        case CANDLE_TRISTAR: {
+            // All three dojis compare with the average of the first.
+            int r = 0;
+            if (TAPP_REALBODY(2) <= TAPP_AVERAGE(BodyDoji, 2) &&
+                TAPP_REALBODY(1) <= TAPP_AVERAGE(BodyDoji, 2) &&
+                TAPP_REALBODY(0) <= TAPP_AVERAGE(BodyDoji, 2)) {
+                if (TAPP_BODYGAPUP(1, 2) && TAPP_BODYMAX(0) < TAPP_BODYMAX(1)) r = -100;
+                if (TAPP_BODYGAPDOWN(1, 2) && TAPP_BODYMIN(0) > TAPP_BODYMIN(1)) r = 100;
+            }
+            return r;
+        }
+        case CANDLE_UNIQUE3RIVER:
+            return TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) && TAPP_COLOR(2) == -1 &&
+                   TAPP_COLOR(1) == -1 && TAPP_C(1) > TAPP_C(2) && TAPP_O(1) <= TAPP_O(2) &&
+                   TAPP_L(1) < TAPP_L(2) &&
+                   TAPP_REALBODY(0) < TAPP_AVERAGE(BodyShort, 0) && TAPP_COLOR(0) == 1 &&
+                   TAPP_O(0) > TAPP_L(1) ? 100 : 0;
+        case CANDLE_UPSIDEGAP2CROWS:
+            return TAPP_COLOR(2) == 1 && TAPP_REALBODY(2) > TAPP_AVERAGE(BodyLong, 2) &&
+                   TAPP_COLOR(1) == -1 && TAPP_REALBODY(1) <= TAPP_AVERAGE(BodyShort, 1) &&
+                   TAPP_BODYGAPUP(1, 2) &&
+                   TAPP_COLOR(0) == -1 && TAPP_O(0) > TAPP_O(1) && TAPP_C(0) < TAPP_C(1) &&
+                   TAPP_C(0) > TAPP_C(2) ? -100 : 0;
+        case CANDLE_XSIDEGAP3METHODS:
+            return TAPP_COLOR(2) == TAPP_COLOR(1) && TAPP_COLOR(1) == -TAPP_COLOR(0) &&
+                   TAPP_O(0) < TAPP_BODYMAX(1) && TAPP_O(0) > TAPP_BODYMIN(1) &&
+                   TAPP_C(0) < TAPP_BODYMAX(2) && TAPP_C(0) > TAPP_BODYMIN(2) &&
+                   ((TAPP_COLOR(2) == 1 && TAPP_BODYGAPUP(1, 2)) ||
+                    (TAPP_COLOR(2) == -1 && TAPP_BODYGAPDOWN(1, 2))) ? TAPP_COLOR(2) * 100 : 0;
+        default:
+            panic();
+        }
+        return 0;
+    }
+
+#undef TAPP_O
+#undef TAPP_H
+#undef TAPP_L
+#undef TAPP_C
+#undef TAPP_REALBODY
+#undef TAPP_UPPERSHADOW
+#undef TAPP_LOWERSHADOW
+#undef TAPP_HIGHLOWRANGE
+#undef TAPP_COLOR
+#undef TAPP_AVERAGE
+#undef TAPP_BODYGAPUP
+#undef TAPP_BODYGAPDOWN
+#undef TAPP_GAPUP
+#undef TAPP_GAPDOWN
+#undef TAPP_BODYMIN
+#undef TAPP_BODYMAX
+
+public:
+    Candlesticks (I _open, I _high, I _low, I _close, TA_Integer _n, CandleMask _patterns,
+                  const CandleSetting *_settings, CandleMask *_mask, CandleMask *_bearish, CandleMask *_strong)
+        : open(_open), high(_high), low(_low), close(_close), n(_n), patterns(_patterns),
+          settings(_settings), mask(_mask), bearish(_bearish), strong(_strong),
+          slots(CANDLE_PATTERNS * TA_AllCandleSettings * OFFSETS, -1) {
+        TA_Integer longest = 0;
+        for (int k = 0; k < CANDLE_PATTERNS; ++k) {
+            CandlePattern pattern = CandlePattern(k);
+            if (!(patterns & TAPP_CANDLE(pattern))) continue;
+            lookback[k] = candleLookback(pattern, settings);
+            start[k] = candleStart(pattern, settings);
+            const CandleRule &rule = candleRule(pattern);
+            for (int j = 0; j < rule.count; ++j) {
+                Total t = { rule.totals[j].setting, rule.totals[j].offset, start[k], 0 };
+                longest = std::max(longest, settings[t.setting].period);
+                unsigned s = 0;
+                while (s < totals.size() && !(totals[s].setting == t.setting && totals[s].offset == t.offset
+                                              && totals[s].start == t.start)) ++s;
+                if (s == totals.size()) totals.push_back(t);
+                slot(pattern, t.setting, t.offset) = s;
+            }
+        }
+        ring.resize(longest + OFFSETS);
+        hikkakeIndex[0] = hikkakeIndex[1] = 0;
+        hikkakeResult[0] = hikkakeResult[1] = 0;
+    }
+
+    void operator () () {
+        std::vector<CandlePattern> active;
+        for (int k = 0; k < CANDLE_PATTERNS; ++k) {
+            if (patterns & TAPP_CANDLE(k)) active.push_back(CandlePattern(k));
+        }
+        for (TA_Integer i = 0; i < n; ++i) {
+            ring[i % ring.size()] = CandleShape(open[i], high[i], low[i], close[i]);
+            for (unsigned j = 0; j < totals.size(); ++j) {
+                Total &t = totals[j];
+                if (t.start != i) continue;
+                const CandleSetting &c = settings[t.setting];
+                for (TA_Integer k = i - c.period; k < i; ++k) t.sum += shape(k - t.offset).of(c.range);
+            }
+            CandleMask m = 0, b = 0, s = 0;
+            for (unsigned k = 0; k < active.size(); ++k) {
+                CandlePattern pattern = active[k];
+                if (i < start[pattern]) continue;
+                int v = find(pattern, i);
+                if (v == 0 || i < lookback[pattern]) continue;
+                CandleMask bit = TAPP_CANDLE(pattern);
+                m |= bit;
+                if (v < 0) b |= bit;
+                if (v == 200 || v == -200) s |= bit;
+            }
+            mask[i] = m;
+            bearish[i] = b;
+            strong[i] = s;
+            for (unsigned j = 0; j < totals.size(); ++j) {
+                Total &t = totals[j];
+                if (i < t.start) continue;
+                const CandleSetting &c = settings[t.setting];
+                t.sum += shape(i - t.offset).of(c.range) - shape(i - t.offset - c.period).of(c.range);
+            }
+        }
+    }
+};
+
+}
+
+/// Candle settings of the candlestick patterns.
+/**
+ * TA-lib decides what a long body or a short shadow is by comparing with
+ * the average of recent candles, each with one of the settings of
+ * TA_CandleSettingType: what range to average, over how many candles, and
+ * a factor.  A CandleSettings starts with TA-lib's defaults; set() changes
+ * a setting like TA_SetCandleSettings.
+ */
+class CandleSettings
+{
+    native::CandleSetting settings[TA_AllCandleSettings];
+public:
+    /// TA-lib's default settings.
+    CandleSettings () {
+        set(TA_BodyLong, TA_RangeType_RealBody, 10, 1.0);
+        set(TA_BodyVeryLong, TA_RangeType_RealBody, 10, 3.0);
+        set(TA_BodyShort, TA_RangeType_RealBody, 10, 1.0);
+        set(TA_BodyDoji, TA_RangeType_HighLow, 10, 0.1);
+        set(TA_ShadowLong, TA_RangeType_RealBody, 0, 1.0);
+        set(TA_ShadowVeryLong, TA_RangeType_RealBody, 0, 2.0);
+        set(TA_ShadowShort, TA_RangeType_Shadows, 10, 1.0);
+        set(TA_ShadowVeryShort, TA_RangeType_HighLow, 10, 0.1);
+        set(TA_Near, TA_RangeType_HighLow, 5, 0.2);
+        set(TA_Far, TA_RangeType_HighLow, 5, 0.6);
+        set(TA_Equal, TA_RangeType_HighLow, 5, 0.05);
+    }
+
+    /// Change a setting.
+    CandleSettings &set (TA_CandleSettingType type, TA_RangeType range, TA_Integer period, double factor) {
+        verify(type >= 0 && type < TA_AllCandleSettings);
+        verify(period >= 0);
+        native::CandleSetting &s = settings[type];
+        s.range = range;
+        s.period = period;
+        s.factor = factor;
+        return *this;
+    }
+
+    /// Get a setting.
+    const native::CandleSetting &get (TA_CandleSettingType type) const {
+        return settings[type];
+    }
+
+    /// All settings, indexed by TA_CandleSettingType.
+    const native::CandleSetting *data () const {
+        return settings;
+    }
+
+    /// Make these the settings of TA-lib.
+    /**
+     * TA-lib's settings are global: this affects all later CDL functions
+     * of TA, on all threads.  Nothing in TA++ calls it implicitly.
+     */
+    void apply () const {
+        for (int k = 0; k < TA_AllCandleSettings; ++k) {
+            const native::CandleSetting &s = settings[k];
+            if (TA_SetCandleSettings(TA_CandleSettingType(k), s.range, s.period, s.factor) != TA_SUCCESS) panic();
+        }
+    }
+};
+
+/// Candlestick patterns of a series of candles.
+/**
+ * The scan keeps, for each bar, the mask of the patterns found, and the
+ * values of TA of the patterns found, their strengths, one after another in
+ * the order of the bits.  get() gives the value of TA of any pattern at
+ * any bar, which is 0 if the pattern is not found.
+ *
+ * All patterns are computed natively with the candle settings given and
+ * TA-lib's default options.  The scan leaves TA-lib's own candle settings
+ * alone; TA of a pattern gives the same values as the scan only if TA-lib
+ * has the same settings, e.g. after CandleSettings::apply().
+ *
+ * \code
+ *      CandleScan scan(candles, TAPP_CANDLE(CANDLE_DOJI) | TAPP_CANDLE(CANDLE_ENGULFING));
+ *      for (unsigned i = 0; i < scan.size(); ++i) {
+ *          if (scan.getMask(i) & TAPP_CANDLE(CANDLE_ENGULFING)) ...
+ *      }
+ * \endcode
+ */
+class CandleScan
+{
+    std::vector<CandleMask> masks;
+    // Strengths of the patterns at bar i start at offsets[i].
+    std::vector<TA_Integer> offsets;
+    std::vector<TA_Integer> strengths;
+
+    static unsigned count (CandleMask m) {
+        unsigned c = 0;
+        for (; m != 0; m &= m - 1) ++c;
+        return c;
+    }
+
+public:
+    /// Scan candles for patterns, a combination of TAPP_CANDLE bits.
+    CandleScan (const Candles &candles, CandleMask patterns = ALL_CANDLE_PATTERNS,
+                const CandleSettings &settings = CandleSettings()) {
+        const RealSeries &open = candles.getOpen(), &high = candles.getHigh();
+        const RealSeries &low = candles.getLow(), &close = candles.getClose();
+        TA_Integer size = candles.size();
+        TA_Integer first = std::max(std::max(open.getFirst(), high.getFirst()),
+                                    std::max(low.getFirst(), close.getFirst()));
+        patterns &= ALL_CANDLE_PATTERNS;
+        masks.assign(size, 0);
+        std::vector<CandleMask> bearish(size, 0), strong(size, 0);
+        if (patterns && size > first) {
+            native::Candlesticks<const TA_Real *> kernel(&open[first], &high[first], &low[first], &close[first],
+                                                         size - first, patterns, settings.data(),
+                                                         &masks[first], &bearish[first], &strong[first]);
+            kernel();
+        }
+        offsets.resize(size + 1);
+        offsets[0] = 0;
+        for (TA_Integer i = 0; i < size; ++i) {
+            offsets[i + 1] = offsets[i] + count(masks[i]);
+        }
+        strengths.reserve(offsets[size]);
+        for (TA_Integer i = 0; i < size; ++i) {
+            for (CandleMask m = masks[i]; m != 0; m &= m - 1) {
+                CandleMask bit = m & -m;
+                TA_Integer v = strong[i] & bit ? 200 : 100;
+                strengths.push_back(bearish[i] & bit ? -v : v);
+            }
+        }
+    }
+
+    /// Number of bars.
+    size_t size () const {
+        return masks.size();
+    }
+
+    /// Patterns found at a bar, a combination of TAPP_CANDLE bits.
+    CandleMask getMask (unsigned i) const {
+        return masks[i];
+    }
+
+    /// Value of TA of a pattern at a bar, 0 if the pattern is not found.
+    TA_Integer get (unsigned i, CandlePattern pattern) const {
+        CandleMask bit = TAPP_CANDLE(pattern);
+        if (!(masks[i] & bit)) return 0;
+        return strengths[offsets[i] + count(masks[i] & (bit - 1))];
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_PRICE
+#define WDONG_TAPP_PRICE
+
+/**
+ * \file ta++-price.h
+ * \brief Native price transforms.
+ *
+ * An indicator of a price transform, such as a moving average of the
+ * typical price, need not store the transform: price() gives it as an
+ * expression, which the native series functions evaluate as they read it,
+ * see ta++-expr.h.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+namespace tapp {
+
+/// Price transforms, see price().
+/**
+ * In order, the transforms of AVGPRICE, MEDPRICE, TYPPRICE and WCLPRICE.
+ */
+enum PriceTransform {
+    PRICE_AVERAGE, PRICE_MEDIAN, PRICE_TYPICAL, PRICE_WEIGHTED_CLOSE, PRICE_TRANSFORMS
+};
+
+namespace native {
+
+/// Price transform P of a bar, as TA-lib computes it.
+/**
+ * The open is only read by PRICE_AVERAGE.
+ */
+template <int P, typename I>
+TAPP_INLINE double price (I open, I high, I low, I close, TA_Integer i)
+{
+    switch (P) {
+    case PRICE_AVERAGE: return (double(high[i]) + double(low[i]) + double(close[i]) + double(open[i])) / 4;
+    case PRICE_MEDIAN: return (double(high[i]) + double(low[i])) / 2.0;
+    case PRICE_TYPICAL: return (double(high[i]) + double(low[i]) + double(close[i])) / 3.0;
+    default: return (double(high[i]) + double(low[i]) + (double(close[i]) * 2.0)) / 4.0;
+    }
+}
+
+/// Price transform kernel.
+template <int P, typename I, typename T>
+struct Price {
+    I open, high, low, close;
+    TA_Integer n, begin;
+    T *out;
+
+    Price (I _open, I _high, I _low, I _close, TA_Integer _n, TA_Integer _begin, T *_out)
+        : open(_open), high(_high), low(_low), close(_close), n(_n), begin(_begin), out(_out) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        T *o = out - begin;
+        for (TA_Integer i = begin; i < n; ++i) o[i] = T(price<P>(open, high, low, close, i));
+    }
+};
+
+template <int P, typename T>
+bool callPrice (const NativeCall<T> &call)
+{
+    dispatch(Price<P, const T *, T>(call.open, call.high, call.low, call.close, call.size, call.lookback, call.out[0]));
+    return true;
+}
+
+template <typename T>
+bool callAVGPRICE (const NativeCall<T> &call)
+{
+    return callPrice<PRICE_AVERAGE>(call);
+}
+
+template <typename T>
+bool callMEDPRICE (const NativeCall<T> &call)
+{
+    return callPrice<PRICE_MEDIAN>(call);
+}
+
+template <typename T>
+bool callTYPPRICE (const NativeCall<T> &call)
+{
+    return callPrice<PRICE_TYPICAL>(call);
+}
+
+template <typename T>
+bool callWCLPRICE (const NativeCall<T> &call)
+{
+    return callPrice<PRICE_WEIGHTED_CLOSE>(call);
+}
+
+}
+
+namespace expr {
+
+/// A price transform of candles as an expression operand.
+template <int P>
+class Price
+{
+    const TA_Real *open, *high, *low, *close;
+    size_t n;
+    TA_Integer first;
+public:
+    typedef TA_Real value_type;
+
+    Price (const Candles &c)
+        : open(c.size() == 0 ? 0 : &c.getOpen()[0]), high(c.size() == 0 ? 0 : &c.getHigh()[0]),
+          low(c.size() == 0 ? 0 : &c.getLow()[0]), close(c.size() == 0 ? 0 : &c.getClose()[0]), n(c.size()),
+          first(std::max(std::max(c.getHigh().getFirst(), c.getLow().getFirst()),
+                         std::max(c.getClose().getFirst(), P == PRICE_AVERAGE ? c.getOpen().getFirst() : 0))) {
+    }
+    TA_Real operator [] (size_t i) const {
+        return native::price<P>(open, high, low, close, TA_Integer(i));
+    }
+    size_t size () const {
+        return n;
+    }
+    TA_Integer getFirst () const {
+        return first;
+    }
+};
+
+}
+
+/// Price transform P of candles as an expression.
+/**
+ * Nothing is computed until the expression is assigned to a series or read
+ * by a native series function, e.g. rsi(price<PRICE_MEDIAN>(candles), 14).
+ * Element i is the same as that of TA of the transform.
+ */
+template <int P>
+inline Expr<expr::Price<P> > price (const Candles &candles)
+{
+    return Expr<expr::Price<P> >(expr::Price<P>(candles));
+}
+
+}
+
+#endif
@@ -0,0 +1,548 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_STATISTIC
+#define WDONG_TAPP_STATISTIC
+
+/**
+ * \file ta++-statistic.h
+ * \brief Native statistic functions.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+namespace tapp {
+
+/// Outputs of the linear regression family, see regression().
+enum RegressionOutput {
+    REGRESSION_LINEARREG, REGRESSION_SLOPE, REGRESSION_INTERCEPT, REGRESSION_ANGLE, REGRESSION_TSF, REGRESSION_OUTPUTS
+};
+
+namespace native {
+
+/// Outputs between two anchors of the rolling variance.
+static const TA_Integer VARIANCE_ANCHOR = 4096;
+
+/// Updates of a window sum of squares about an anchor.
+template <typename I>
+struct WindowSquareDelta {
+    I in;
+    TA_Integer period;
+    double anchor;
+
+    WindowSquareDelta (I _in, TA_Integer _period, double _anchor)
+        : in(_in), period(_period), anchor(_anchor) {
+    }
+
+    double operator [] (TA_Integer i) const {
+        double a = double(in[i]) - anchor;
+        double b = double(in[i - period]) - anchor;
+        return a * a - b * b;
+    }
+};
+
+/// Rolling mean and population variance kernel.
+/**
+ * TA-lib computes the variance as the difference of the running means of
+ * x^2 and x, which cancels catastrophically when the deviation is small
+ * next to the prices.  Here the running sums are of x - c, for an anchor c
+ * taken from the data every VARIANCE_ANCHOR outputs, where the window sums
+ * are also recomputed from scratch so rounding does not accumulate.  The
+ * sums slide through Recurrence.  The lookback is period - 1.
+ */
+template <typename I>
+struct Variance {
+    I in;
+    TA_Integer n, period, begin;
+    double *mean, *var;
+    Recurrence sum;
+
+    Variance (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _begin, double *_mean, double *_var)
+        : in(_in), n(_n), period(_period), begin(_begin), mean(_mean), var(_var), sum(1, 1) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        const double scale = 1.0 / period;
+        for (TA_Integer b = begin; b < n; b += VARIANCE_ANCHOR) {
+            TA_Integer e = std::min(n, b + VARIANCE_ANCHOR);
+            double anchor = in[b];
+            double s1 = 0, s2 = 0;
+            for (TA_Integer i = b - period + 1; i <= b; ++i) {
+                double d = double(in[i]) - anchor;
+                s1 += d;
+                s2 += d * d;
+            }
+            mean[b - begin] = s1 * scale;
+            var[b - begin] = s2 * scale;
+            sum.run(WindowDelta<I>(in, period), b + 1, e, s1, begin, scale, mean);
+            sum.run(WindowSquareDelta<I>(in, period, anchor), b + 1, e, s2, begin, scale, var);
+            for (TA_Integer i = b - begin; i < e - begin; ++i) {
+                double m = mean[i];
+                var[i] -= m * m;
+                mean[i] = m + anchor;
+            }
+        }
+    }
+};
+
+/// Rolling mean and population variance.
+/**
+ * Writes both for every input element i >= begin.  The lookback is
+ * period - 1.
+ */
+template <typename I>
+void variance (I in, TA_Integer n, TA_Integer period, TA_Integer begin, double *mean, double *var)
+{
+    dispatch(Variance<I>(in, n, period, begin, mean, var));
+}
+
+/// Standard deviation from a variance as TA-lib does, 0 for tiny variances.
+static inline double deviation (double var) {
+    return isZeroOrNeg(var) ? 0 : std::sqrt(var);
+}
+
+/// Minimum number of outputs between two anchors of the rolling regression.
+static const TA_Integer REGRESSION_ANCHOR = 64;
+
+/// Rolling linear regression kernel.
+/**
+ * LINEARREG, LINEARREG_SLOPE, LINEARREG_INTERCEPT, LINEARREG_ANGLE and TSF
+ * all fit a least-squares line to the window, which TA-lib sums anew for
+ * every output.  When the window slides by one, the sum of y changes by
+ * the element that enters and the one that leaves, and the sum of x y,
+ * with x the age of an element, by the sum of y less period times the
+ * element that leaves.  So each output costs O(1) whatever the period.  As
+ * in Variance, the sums are of y - c for an anchor c, and are recomputed
+ * every period outputs, but no more often than every REGRESSION_ANCHOR,
+ * so rounding does not accumulate.  TA-lib computes the sum of x^2 in int,
+ * which overflows for periods over about 1000, so only below that are the
+ * results the same.  out is indexed by RegressionOutput and null for
+ * outputs not wanted.  The lookback is period - 1.
+ */
+template <typename I, typename T>
+struct LinearRegression {
+    I in;
+    TA_Integer n, period, begin;
+    T *const *out;
+
+    LinearRegression (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _begin, T *const *_out)
+        : in(_in), n(_n), period(_period), begin(_begin), out(_out) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        const double p = period;
+        const double sumX = p * (p - 1) * 0.5;
+        const double sumXSqr = p * (p - 1) * (p * 2 - 1) / 6;
+        const double divisor = sumX * sumX - p * sumXSqr;
+        const double rad2Deg = 180.0 / 3.14159265358979323846;
+        const TA_Integer anchors = std::max(period, REGRESSION_ANCHOR);
+        for (TA_Integer b = begin; b < n; b += anchors) {
+            TA_Integer e = std::min(n, b + anchors);
+            double anchor = in[b];
+            double sumY = 0, sumXY = 0;
+            for (TA_Integer i = period; i-- != 0; ) {
+                double y = double(in[b - i]) - anchor;
+                sumY += y;
+                sumXY += double(i) * y;
+            }
+            for (TA_Integer i = b; ; ) {
+                double m = (p * sumXY - sumX * sumY) / divisor;
+                double c = (sumY - m * sumX) / p + anchor;
+                TA_Integer j = i - begin;
+                if (out[REGRESSION_LINEARREG]) out[REGRESSION_LINEARREG][j] = T(c + m * (p - 1));
+                if (out[REGRESSION_SLOPE]) out[REGRESSION_SLOPE][j] = T(m);
+                if (out[REGRESSION_INTERCEPT]) out[REGRESSION_INTERCEPT][j] = T(c);
+                if (out[REGRESSION_ANGLE]) out[REGRESSION_ANGLE][j] = T(std::atan(m) * rad2Deg);
+                if (out[REGRESSION_TSF]) out[REGRESSION_TSF][j] = T(c + m * p);
+                if (++i >= e) break;
+                double leaving = double(in[i - period]) - anchor;
+                sumXY += sumY - p * leaving;
+                sumY += (double(in[i]) - anchor) - leaving;
+            }
+        }
+    }
+};
+
+/// Rolling linear regression, see LinearRegression.
+template <typename I, typename T>
+void regression (I in, TA_Integer n, TA_Integer period, TA_Integer begin, T *const *out)
+{
+    dispatch(LinearRegression<I, T>(in, n, period, begin, out));
+}
+
+/// Updates of a window sum of products about anchors.
+template <typename I, typename J>
+struct WindowProductDelta {
+    I x;
+    J y;
+    TA_Integer period;
+    double a, c;
+
+    WindowProductDelta (I _x, J _y, TA_Integer _period, double _a, double _c)
+        : x(_x), y(_y), period(_period), a(_a), c(_c) {
+    }
+
+    double operator [] (TA_Integer i) const {
+        return (double(x[i]) - a) * (double(y[i]) - c) - (double(x[i - period]) - a) * (double(y[i - period]) - c);
+    }
+};
+
+/// Rolling window sums of x - a and (x - a)^2.
+/**
+ * The sums of the window ending at each element i >= begin are written to
+ * sum[i - begin] and square[i - begin].  The anchor a is the element at
+ * the start of each block of VARIANCE_ANCHOR outputs from begin on, where
+ * the sums are recomputed.
+ */
+template <typename I>
+struct Moments {
+    I in;
+    TA_Integer n, period, begin;
+    double *sum, *square;
+
+    Moments (I _in, TA_Integer _n, TA_Integer _period, TA_Integer _begin, double *_sum, double *_square)
+        : in(_in), n(_n), period(_period), begin(_begin), sum(_sum), square(_square) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        const Recurrence window(1, 1);
+        for (TA_Integer b = begin; b < n; b += VARIANCE_ANCHOR) {
+            TA_Integer e = std::min(n, b + VARIANCE_ANCHOR);
+            double anchor = in[b];
+            double s1 = 0, s2 = 0;
+            for (TA_Integer i = b - period + 1; i <= b; ++i) {
+                double d = double(in[i]) - anchor;
+                s1 += d;
+                s2 += d * d;
+            }
+            sum[b - begin] = s1;
+            square[b - begin] = s2;
+            window.run(WindowDelta<I>(in, period), b + 1, e, s1, begin, 1.0, sum);
+            window.run(WindowSquareDelta<I>(in, period, anchor), b + 1, e, s2, begin, 1.0, square);
+        }
+    }
+};
+
+/// Number of elements Comoments finishes at a time.
+static const TA_Integer COMOMENT_CHUNK = 256;
+
+/// Rolling correlation or beta of y against x.
+/**
+ * sx and sq are the Moments of x from begin on, computed once and shared
+ * by all y against the same x.  The window sums of y and of the products
+ * slide through Recurrence, a chunk at a time, with the anchors of
+ * Moments, and each chunk is finished by a loop without dependencies
+ * between elements, which vectorizes.  With BETA, x and y are returns and
+ * the output is TA-lib's beta of y against x, otherwise it is Pearson's
+ * correlation as TA-lib computes it.  Running sums about anchors do not
+ * cancel catastrophically as TA-lib's sums of prices do, so the results
+ * agree with TA-lib's up to TA-lib's rounding.
+ */
+template <bool BETA, typename I, typename T>
+struct Comoments {
+    I x, y;
+    TA_Integer n, period, begin;
+    const double *sx, *sq;
+    T *out;
+
+    Comoments (I _x, I _y, TA_Integer _n, TA_Integer _period, TA_Integer _begin,
+               const double *_sx, const double *_sq, T *_out)
+        : x(_x), y(_y), n(_n), period(_period), begin(_begin), sx(_sx), sq(_sq), out(_out) {
+    }
+
+    static double finish (double p, double sx, double sq, double sy, double sr, double sp) {
+        if (BETA) {
+            double d = (p * sq) - (sx * sx);
+            return isZero(d) ? 0 : ((p * sp) - (sx * sy)) / d;
+        }
+        double d = (sq - ((sx * sx) / p)) * (sr - ((sy * sy) / p));
+        return isZeroOrNeg(d) ? 0 : (sp - ((sx * sy) / p)) / std::sqrt(d);
+    }
+
+    TAPP_INLINE void operator () () const {
+        const Recurrence window(1, 1);
+        const double p = period;
+        double sy[COMOMENT_CHUNK], sr[COMOMENT_CHUNK], sp[COMOMENT_CHUNK];
+        for (TA_Integer b = begin; b < n; b += VARIANCE_ANCHOR) {
+            TA_Integer e = std::min(n, b + VARIANCE_ANCHOR);
+            double a = x[b], c = y[b];
+            double s1 = 0, s2 = 0, s3 = 0;
+            for (TA_Integer i = b - period + 1; i <= b; ++i) {
+                double u = double(x[i]) - a, v = double(y[i]) - c;
+                s1 += v;
+                s2 += v * v;
+                s3 += u * v;
+            }
+            out[b - begin] = T(finish(p, sx[b - begin], sq[b - begin], s1, s2, s3));
+            for (TA_Integer c0 = b + 1; c0 < e; c0 += COMOMENT_CHUNK) {
+                TA_Integer c1 = std::min(e, c0 + COMOMENT_CHUNK);
+                s1 = window.run(WindowDelta<I>(y, period), c0, c1, s1, c0, 1.0, sy);
+                s2 = window.run(WindowSquareDelta<I>(y, period, c), c0, c1, s2, c0, 1.0, sr);
+                s3 = window.run(WindowProductDelta<I, I>(x, y, period, a, c), c0, c1, s3, c0, 1.0, sp);
+                const double *cx = sx + (c0 - begin), *cq = sq + (c0 - begin);
+                T *o = out + (c0 - begin);
+                for (TA_Integer j = 0; j < c1 - c0; ++j) o[j] = T(finish(p, cx[j], cq[j], sy[j], sr[j], sp[j]));
+            }
+        }
+    }
+};
+
+/// Rates of change of prices as BETA computes them, 0 after a zero price.
+/**
+ * Writes out[i - from] for from <= i < to, where from is at least 1.
+ */
+template <typename I>
+void returns (I in, TA_Integer from, TA_Integer to, double *out)
+{
+    for (TA_Integer i = from; i < to; ++i) {
+        double previous = in[i - 1];
+        out[i - from] = isZero(previous) ? 0 : (double(in[i]) - previous) / previous;
+    }
+}
+
+/// Rolling correlations or betas of many inputs against one.
+/**
+ * x and every y[k] have n elements.  out[k] receives the outputs of y[k]
+ * from begin on.  With BETA the lookback is period, and the inputs are
+ * prices turned into returns, otherwise the lookback is period - 1.
+ *
+ * The work goes one anchor block of Moments at a time: the moments of the
+ * block of x are computed once, and every y is run against them while the
+ * block is in cache, so x is read from memory once however many y there
+ * are.  The blocks have the anchors of a run over all elements, so the
+ * results do not depend on the blocking.
+ */
+template <bool BETA, typename I, typename T>
+void comoments (I x, const I *y, TA_Integer count, TA_Integer n, TA_Integer period, TA_Integer begin,
+                T *const *out)
+{
+    if (n <= begin) return;
+    TA_Integer block = std::min(VARIANCE_ANCHOR, n - begin);
+    std::vector<double> sx(block), sq(block);
+    std::vector<double> rx(BETA ? block + period - 1 : 0), ry(rx.size());
+    for (TA_Integer b = begin; b < n; b += VARIANCE_ANCHOR) {
+        // Elements from - 1 < i < e of the inputs, renumbered from 0, with
+        // the first output at period - 1.
+        TA_Integer e = std::min(n, b + VARIANCE_ANCHOR);
+        TA_Integer from = b - period + 1, m = e - from;
+        if (BETA) {
+            returns(x, from, e, &rx[0]);
+            dispatch(Moments<const double *>(&rx[0], m, period, period - 1, &sx[0], &sq[0]));
+        }
+        else dispatch(Moments<I>(x + from, m, period, period - 1, &sx[0], &sq[0]));
+        for (TA_Integer k = 0; k < count; ++k) {
+            T *o = out[k] + (b - begin);
+            if (BETA) {
+                returns(y[k], from, e, &ry[0]);
+                dispatch(Comoments<true, const double *, T>(&rx[0], &ry[0], m, period, period - 1,
+                                                            &sx[0], &sq[0], o));
+            }
+            else dispatch(Comoments<false, I, T>(x + from, y[k] + from, m, period, period - 1, &sx[0], &sq[0], o));
+        }
+    }
+}
+
+template <typename T>
+bool callBETA (const NativeCall<T> &call)
+{
+    comoments<true>(call.real[0], &call.real[1], 1, call.size, call.integer(0), call.lookback, &call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callCORREL (const NativeCall<T> &call)
+{
+    comoments<false>(call.real[0], &call.real[1], 1, call.size, call.integer(0), call.lookback, &call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callRegression (const NativeCall<T> &call, RegressionOutput output)
+{
+    T *out[REGRESSION_OUTPUTS] = {0};
+    out[output] = call.out[0];
+    regression(call.real[0], call.size, call.integer(0), call.lookback, out);
+    return true;
+}
+
+template <typename T>
+bool callLINEARREG (const NativeCall<T> &call)
+{
+    return callRegression(call, REGRESSION_LINEARREG);
+}
+
+template <typename T>
+bool callLINEARREG_ANGLE (const NativeCall<T> &call)
+{
+    return callRegression(call, REGRESSION_ANGLE);
+}
+
+template <typename T>
+bool callLINEARREG_INTERCEPT (const NativeCall<T> &call)
+{
+    return callRegression(call, REGRESSION_INTERCEPT);
+}
+
+template <typename T>
+bool callLINEARREG_SLOPE (const NativeCall<T> &call)
+{
+    return callRegression(call, REGRESSION_SLOPE);
+}
+
+template <typename T>
+bool callTSF (const NativeCall<T> &call)
+{
+    return callRegression(call, REGRESSION_TSF);
+}
+
+template <typename T>
+bool callVAR (const NativeCall<T> &call)
+{
+    TA_Integer m = call.size - call.lookback;
+    std::vector<double> mean(m), var(m);
+    variance(call.real[0], call.size, call.integer(0), call.lookback, &mean[0], &var[0]);
+    std::copy(var.begin(), var.end(), call.out[0]);
+    return true;
+}
+
+template <typename T>
+bool callSTDDEV (const NativeCall<T> &call)
+{
+    TA_Integer m = call.size - call.lookback;
+    std::vector<double> mean(m), var(m);
+    variance(call.real[0], call.size, call.integer(0), call.lookback, &mean[0], &var[0]);
+    const double nbDev = call.options[1];
+    for (TA_Integer i = 0; i < m; ++i) call.out[0][i] = T(deviation(var[i]) * nbDev);
+    return true;
+}
+
+}
+
+/// Rolling population variance, the same as TA("VAR", input) up to rounding.
+template <typename S>
+Series<typename Operand<S>::value_type> variance (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    TA_Integer n = native::prepareOutput(input, period - 1, output);
+    if (n == 0) return output;
+    std::vector<double> mean(n - period + 1), var(n - period + 1);
+    native::variance(native::elements(input), n, period, period - 1, &mean[0], &var[0]);
+    std::copy(var.begin(), var.end(), output.begin() + output.getFirst());
+    return output;
+}
+
+/// Rolling standard deviation, the same as TA("STDDEV", input) up to rounding.
+template <typename S>
+Series<typename Operand<S>::value_type> stddev (const S &input, TA_Integer period, double nbDev = 1)
+{
+    typedef typename Operand<S>::value_type T;
+    Series<T> output;
+    TA_Integer n = native::prepareOutput(input, period - 1, output);
+    if (n == 0) return output;
+    std::vector<double> mean(n - period + 1), var(n - period + 1);
+    native::variance(native::elements(input), n, period, period - 1, &mean[0], &var[0]);
+    for (unsigned i = 0; i < var.size(); ++i) {
+        output[output.getFirst() + i] = T(native::deviation(var[i]) * nbDev);
+    }
+    return output;
+}
+
+/// Rolling linear regression in one pass.
+/**
+ * Returns the REGRESSION_OUTPUTS series indexed by RegressionOutput, each
+ * the same as TA of its function up to rounding.
+ */
+template <typename S>
+std::vector<Series<typename Operand<S>::value_type> > regression (const S &input, TA_Integer period)
+{
+    typedef typename Operand<S>::value_type T;
+    std::vector<Series<T> > r(REGRESSION_OUTPUTS);
+    T *out[REGRESSION_OUTPUTS];
+    TA_Integer n = 0;
+    for (int k = 0; k < REGRESSION_OUTPUTS; ++k) {
+        n = native::prepareOutput(input, period - 1, r[k]);
+        out[k] = n == 0 ? 0 : &r[k][r[k].getFirst()];
+    }
+    if (n == 0) return r;
+    native::regression(native::elements(input), n, period, period - 1, out);
+    return r;
+}
+
+namespace detail {
+
+template <bool BETA, typename T>
+std::vector<Series<T> > comoments (const Series<T> &benchmark, const std::vector<Series<T> > &series,
+                                   TA_Integer period)
+{
+    TA_Integer first = benchmark.getFirst(), size = benchmark.size();
+    for (unsigned k = 0; k < series.size(); ++k) {
+        first = std::max(first, series[k].getFirst());
+        size = std::min(size, TA_Integer(series[k].size()));
+    }
+    TA_Integer lookback = BETA ? period : period - 1;
+    std::vector<Series<T> > r(series.size());
+    std::vector<const T *> y(series.size());
+    std::vector<T *> out(series.size());
+    for (unsigned k = 0; k < series.size(); ++k) {
+        r[k].resize(size);
+        r[k].setFirst(std::min(first + lookback, size));
+    }
+    if (series.empty() || size - first <= lookback) return r;
+    for (unsigned k = 0; k < series.size(); ++k) {
+        y[k] = &series[k][first];
+        out[k] = &r[k][0] + first + lookback;
+    }
+    native::comoments<BETA>(&benchmark[first], &y[0], TA_Integer(series.size()), size - first, period, lookback, &out[0]);
+    return r;
+}
+
+}
+
+/// Rolling correlations of many series with one benchmark.
+/**
+ * Element k of the result is TA("CORREL", benchmark, series[k]) up to
+ * rounding, where all outputs start from the latest first of the inputs.
+ * The moments of the benchmark are computed once for all series.
+ */
+template <typename T>
+std::vector<Series<T> > correlations (const Series<T> &benchmark, const std::vector<Series<T> > &series,
+                                      TA_Integer period = 30)
+{
+    return detail::comoments<false>(benchmark, series, period);
+}
+
+/// Rolling betas of many series against one benchmark.
+/**
+ * Element k of the result is TA("BETA", benchmark, series[k]) up to
+ * rounding, the beta of the returns of series[k] against those of the
+ * benchmark, see correlations().
+ */
+template <typename T>
+std::vector<Series<T> > betas (const Series<T> &benchmark, const std::vector<Series<T> > &series,
+                               TA_Integer period = 5)
+{
+    return detail::comoments<true>(benchmark, series, period);
+}
+
+}
+
+#endif
+
@@ -0,0 +1,238 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_VOLATILITY
+#define WDONG_TAPP_VOLATILITY
+
+/**
+ * \file ta++-volatility.h
+ * \brief Native volatility indicators.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+namespace tapp {
+
+/// Indicators of the volatility family, see volatility().
+enum VolatilityIndicator {
+    VOLATILITY_TRANGE, VOLATILITY_ATR, VOLATILITY_NATR, VOLATILITY_INDICATORS
+};
+
+namespace native {
+
+/// True range of a bar given the close of the bar before.
+static inline double trueRange (double high, double low, double previousClose) {
+    return std::max(high - low, std::max(std::fabs(high - previousClose), std::fabs(low - previousClose)));
+}
+
+/// Number of true ranges Volatility computes at a time.
+static const TA_Integer VOLATILITY_BLOCK = 256;
+
+/// Volatility kernel.
+/**
+ * TRANGE, ATR and NATR share the true range, so this kernel computes any
+ * subset of them in one pass.  out and begin are indexed by
+ * VolatilityIndicator.  out[k] is null if indicator k is not wanted, and
+ * otherwise receives element i - begin[k] for every input element
+ * i >= begin[k].  begin[k] must not be less than the lookback of k: 1 for
+ * TRANGE and period for ATR and NATR, plus any unstable period.
+ *
+ * The true ranges of a block of elements do not depend on each other and
+ * vectorize.  The ATR starts with the average of the first period true
+ * ranges and continues with Wilder's smoothing, evaluated by Recurrence.
+ * As in TA-lib, a period of 1 makes ATR and NATR the true range itself,
+ * not normalized by the close.
+ */
+template <typename I, typename T>
+struct Volatility {
+    I high, low, close;
+    TA_Integer n, period;
+    T *const *out;
+    const TA_Integer *begin;
+
+    Volatility (I _high, I _low, I _close, TA_Integer _n, TA_Integer _period,
+                T *const *_out, const TA_Integer *_begin)
+        : high(_high), low(_low), close(_close), n(_n), period(_period), out(_out), begin(_begin) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        const Recurrence smooth(double(period - 1) / period, 1.0 / period);
+        double range[VOLATILITY_BLOCK], atr[VOLATILITY_BLOCK];
+        double sum = 0, carry = 0;
+        for (TA_Integer i0 = 1; i0 < n; i0 += VOLATILITY_BLOCK) {
+            TA_Integer m = std::min(VOLATILITY_BLOCK, n - i0);
+            for (TA_Integer j = 0; j < m; ++j) {
+                range[j] = trueRange(high[i0 + j], low[i0 + j], close[i0 + j - 1]);
+            }
+            if (out[VOLATILITY_TRANGE]) {
+                for (TA_Integer j = std::max<TA_Integer>(begin[VOLATILITY_TRANGE] - i0, 0); j < m; ++j) {
+                    out[VOLATILITY_TRANGE][i0 + j - begin[VOLATILITY_TRANGE]] = T(range[j]);
+                }
+            }
+            if (!out[VOLATILITY_ATR] && !out[VOLATILITY_NATR]) continue;
+            TA_Integer j = 0;
+            for (; j < m && i0 + j <= period; ++j) {
+                sum += range[j];
+                if (i0 + j == period) atr[j] = carry = sum / period;
+            }
+            carry = smooth.run(range, j, m, carry, 0, 1.0, atr);
+            if (out[VOLATILITY_ATR]) {
+                for (j = std::max(begin[VOLATILITY_ATR] - i0, TA_Integer(0)); j < m; ++j) {
+                    out[VOLATILITY_ATR][i0 + j - begin[VOLATILITY_ATR]] = T(atr[j]);
+                }
+            }
+            if (out[VOLATILITY_NATR]) {
+                for (j = std::max(begin[VOLATILITY_NATR] - i0, TA_Integer(0)); j < m; ++j) {
+                    double c = close[i0 + j];
+                    double natr = period <= 1 ? atr[j] : isZero(c) ? 0 : (atr[j] / c) * 100.0;
+                    out[VOLATILITY_NATR][i0 + j - begin[VOLATILITY_NATR]] = T(natr);
+                }
+            }
+        }
+    }
+};
+
+/// Volatility indicators, see Volatility.
+template <typename I, typename T>
+void volatility (I high, I low, I close, TA_Integer n, TA_Integer period,
+                 T *const *out, const TA_Integer *begin)
+{
+    dispatch(Volatility<I, T>(high, low, close, n, period, out, begin));
+}
+
+template <typename T>
+bool callVolatility (const NativeCall<T> &call, VolatilityIndicator indicator, TA_Integer period)
+{
+    T *out[VOLATILITY_INDICATORS] = {0};
+    TA_Integer begin[VOLATILITY_INDICATORS] = {0};
+    out[indicator] = call.out[0];
+    begin[indicator] = call.lookback;
+    volatility(call.high, call.low, call.close, call.size, period, out, begin);
+    return true;
+}
+
+template <typename T>
+bool callATR (const NativeCall<T> &call)
+{
+    return callVolatility(call, VOLATILITY_ATR, call.integer(0));
+}
+
+template <typename T>
+bool callNATR (const NativeCall<T> &call)
+{
+    return callVolatility(call, VOLATILITY_NATR, call.integer(0));
+}
+
+template <typename T>
+bool callTRANGE (const NativeCall<T> &call)
+{
+    return callVolatility(call, VOLATILITY_TRANGE, 1);
+}
+
+}
+
+/// TRANGE, ATR and NATR in one pass over the candles.
+/**
+ * Returns the VOLATILITY_INDICATORS series indexed by VolatilityIndicator,
+ * each the same as TA of its indicator with optInTimePeriod period,
+ * including the unstable period.
+ */
+static inline std::vector<RealSeries> volatility (const Candles &candles, TA_Integer period = 14)
+{
+    const TA_Integer lookback[VOLATILITY_INDICATORS] = {
+        TA_TRANGE_Lookback(), TA_ATR_Lookback(period), TA_NATR_Lookback(period)
+    };
+    std::vector<RealSeries> r(VOLATILITY_INDICATORS);
+    TA_Real *out[VOLATILITY_INDICATORS] = {0};
+    const RealSeries &close = candles.getClose();
+    TA_Integer first = close.getFirst();
+    TA_Integer n = TA_Integer(close.size()) - first;
+    for (int k = 0; k < VOLATILITY_INDICATORS; ++k) {
+        if (native::prepareOutput(close, lookback[k], r[k]) > 0) out[k] = &r[k][r[k].getFirst()];
+    }
+    if (out[VOLATILITY_TRANGE] == 0) return r;
+    native::volatility(&candles.getHigh()[first], &candles.getLow()[first], &close[first],
+                       n, period, out, lookback);
+    return r;
+}
+
+/// True range, ATR and NATR of live bars.
+/**
+ * Computing the indicators over the whole series again for each new bar
+ * costs O(n) per bar.  This state takes one bar at a time in constant
+ * time and memory, and after the same bars its values are those of
+ * volatility() at the last bar, without unstable period.
+ */
+class VolatilityState
+{
+    TA_Integer period, count;
+    double previousClose, sum, range, atr, natr;
+public:
+    VolatilityState (TA_Integer _period = 14)
+        : period(_period), count(0), previousClose(0), sum(0), range(0), atr(0), natr(0) {
+    }
+
+    /// Add the next bar.
+    void push (double high, double low, double close) {
+        if (count > 0) {
+            range = native::trueRange(high, low, previousClose);
+            if (count < period) sum += range;
+            else if (count == period) atr = (sum + range) / period;
+            else atr = ((atr * (period - 1)) + range) / period;
+            if (count >= period) {
+                natr = period <= 1 ? atr : native::isZero(close) ? 0 : (atr / close) * 100.0;
+            }
+        }
+        previousClose = close;
+        ++count;
+    }
+
+    /// Add the next candle.
+    void push (const Candle &candle) {
+        push(candle.high, candle.low, candle.close);
+    }
+
+    /// Number of bars added.
+    TA_Integer size () const {
+        return count;
+    }
+
+    /// Check whether ATR and NATR are available, from bar period on.
+    bool ready () const {
+        return count > period;
+    }
+
+    /// True range of the last bar, available from bar 1 on.
+    double getTrueRange () const {
+        return range;
+    }
+
+    double getATR () const {
+        return atr;
+    }
+
+    double getNATR () const {
+        return natr;
+    }
+};
+
+}
+
+#endif
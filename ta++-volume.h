@@ -0,0 +1,255 @@
+/*
+ * TA++ Copyright (c) 2008-2009, Wei Dong  wdong.pku@gmail.com
+ * All rights reserved.
+ *
+ * FOR PERSONAL AND NON-COMMERCIAL USE ONLY.  REDISTRIBUTION IS NOT PERMITTED.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ */
+
+#ifndef WDONG_TAPP_VOLUME
+#define WDONG_TAPP_VOLUME
+
+/**
+ * \file ta++-volume.h
+ * \brief Native volume indicators.
+ *
+ * This file is included by ta++-native.h and should not be included
+ * directly.
+ */
+
+namespace tapp {
+
+/// Indicators of the volume family, see volume().
+enum VolumeIndicator {
+    VOLUME_AD, VOLUME_ADOSC, VOLUME_OBV, VOLUME_INDICATORS
+};
+
+namespace native {
+
+/// Money flow volume of a bar, the update of the A/D line.
+static inline double moneyFlow (double high, double low, double close, double volume) {
+    double range = high - low;
+    return range > 0.0 ? (((close - low) - (high - close)) / range) * volume : 0.0;
+}
+
+/// Volume of a bar signed by the move of the price, the update of OBV.
+static inline double signedVolume (double price, double previousPrice, double volume) {
+    return price > previousPrice ? volume : (price < previousPrice ? -volume : 0.0);
+}
+
+/// Number of bars Volume computes at a time.
+static const TA_Integer VOLUME_BLOCK = 256;
+
+/// Volume kernel.
+/**
+ * AD and ADOSC share the A/D line, and OBV is a running sum of the same
+ * shape, so this kernel computes any subset of them in one pass.  out and
+ * begin are indexed by VolumeIndicator as with Volatility.  begin[k] must
+ * not be less than the lookback of k: 0 for AD and OBV, and the EMA
+ * lookback of the slower period for ADOSC.  OBV is computed over price,
+ * which is the close for candles.
+ *
+ * The updates of a block of bars do not depend on each other and
+ * vectorize, and the running sums and the EMAs of ADOSC, which TA-lib
+ * starts with the first A/D value, are evaluated by Recurrence.
+ */
+template <typename I, typename T>
+struct Volume {
+    I high, low, close, price, volume;
+    TA_Integer n, fast, slow;
+    T *const *out;
+    const TA_Integer *begin;
+
+    Volume (I _high, I _low, I _close, I _price, I _volume, TA_Integer _n, TA_Integer _fast, TA_Integer _slow,
+            T *const *_out, const TA_Integer *_begin)
+        : high(_high), low(_low), close(_close), price(_price), volume(_volume),
+          n(_n), fast(_fast), slow(_slow), out(_out), begin(_begin) {
+    }
+
+    TAPP_INLINE void operator () () const {
+        const Recurrence sum(1, 1);
+        const double fastK = 2.0 / (fast + 1), slowK = 2.0 / (slow + 1);
+        const Recurrence fastEMA(1 - fastK, fastK), slowEMA(1 - slowK, slowK);
+        const bool line = out[VOLUME_AD] || out[VOLUME_ADOSC];
+        double flow[VOLUME_BLOCK], ad[VOLUME_BLOCK], fastAD[VOLUME_BLOCK], slowAD[VOLUME_BLOCK];
+        double lineCarry = 0, fastCarry = 0, slowCarry = 0, obvCarry = 0;
+        for (TA_Integer i0 = 0; i0 < n; i0 += VOLUME_BLOCK) {
+            TA_Integer m = std::min(VOLUME_BLOCK, n - i0);
+            if (line) {
+                for (TA_Integer j = 0; j < m; ++j) {
+                    flow[j] = moneyFlow(high[i0 + j], low[i0 + j], close[i0 + j], volume[i0 + j]);
+                }
+                lineCarry = sum.run(flow, 0, m, lineCarry, 0, 1.0, ad);
+                if (out[VOLUME_AD]) {
+                    for (TA_Integer j = std::max(begin[VOLUME_AD] - i0, TA_Integer(0)); j < m; ++j) {
+                        out[VOLUME_AD][i0 + j - begin[VOLUME_AD]] = T(ad[j]);
+                    }
+                }
+            }
+            if (out[VOLUME_ADOSC]) {
+                TA_Integer j = 0;
+                if (i0 == 0) {
+                    fastAD[0] = slowAD[0] = fastCarry = slowCarry = ad[0];
+                    j = 1;
+                }
+                fastCarry = fastEMA.run(ad, j, m, fastCarry, 0, 1.0, fastAD);
+                slowCarry = slowEMA.run(ad, j, m, slowCarry, 0, 1.0, slowAD);
+                for (j = std::max(begin[VOLUME_ADOSC] - i0, TA_Integer(0)); j < m; ++j) {
+                    out[VOLUME_ADOSC][i0 + j - begin[VOLUME_ADOSC]] = T(fastAD[j] - slowAD[j]);
+                }
+            }
+            if (out[VOLUME_OBV]) {
+                TA_Integer j = 0;
+                if (i0 == 0) {
+                    obvCarry = volume[0];
+                    if (begin[VOLUME_OBV] == 0) out[VOLUME_OBV][0] = T(obvCarry);
+                    j = 1;
+                }
+                for (TA_Integer k = j; k < m; ++k) {
+                    flow[k] = signedVolume(price[i0 + k], price[i0 + k - 1], volume[i0 + k]);
+                }
+                obvCarry = sum.run(flow, j, m, obvCarry, begin[VOLUME_OBV] - i0, 1.0, out[VOLUME_OBV]);
+            }
+        }
+    }
+};
+
+/// Volume indicators, see Volume.
+template <typename I, typename T>
+void volume (I high, I low, I close, I price, I volume, TA_Integer n, TA_Integer fast, TA_Integer slow,
+             T *const *out, const TA_Integer *begin)
+{
+    dispatch(Volume<I, T>(high, low, close, price, volume, n, fast, slow, out, begin));
+}
+
+template <typename T>
+bool callVolume (const NativeCall<T> &call, VolumeIndicator indicator, TA_Integer fast, TA_Integer slow)
+{
+    T *out[VOLUME_INDICATORS] = {0};
+    TA_Integer begin[VOLUME_INDICATORS] = {0};
+    out[indicator] = call.out[0];
+    begin[indicator] = call.lookback;
+    volume(call.high, call.low, call.close, call.real[0], call.volume, call.size, fast, slow, out, begin);
+    return true;
+}
+
+template <typename T>
+bool callAD (const NativeCall<T> &call)
+{
+    return callVolume(call, VOLUME_AD, 2, 2);
+}
+
+template <typename T>
+bool callADOSC (const NativeCall<T> &call)
+{
+    return callVolume(call, VOLUME_ADOSC, call.integer(0), call.integer(1));
+}
+
+template <typename T>
+bool callOBV (const NativeCall<T> &call)
+{
+    return callVolume(call, VOLUME_OBV, 2, 2);
+}
+
+}
+
+/// AD, ADOSC and OBV in one pass over the candles.
+/**
+ * Returns the VOLUME_INDICATORS series indexed by VolumeIndicator, each
+ * the same as TA of its indicator, ADOSC with optInFastPeriod fast and
+ * optInSlowPeriod slow, and OBV over the close.
+ */
+static inline std::vector<RealSeries> volume (const Candles &candles, TA_Integer fast = 3, TA_Integer slow = 10)
+{
+    const TA_Integer lookback[VOLUME_INDICATORS] = {
+        TA_AD_Lookback(), TA_ADOSC_Lookback(fast, slow), TA_OBV_Lookback()
+    };
+    std::vector<RealSeries> r(VOLUME_INDICATORS);
+    TA_Real *out[VOLUME_INDICATORS] = {0};
+    const RealSeries &close = candles.getClose();
+    TA_Integer first = close.getFirst();
+    TA_Integer n = TA_Integer(close.size()) - first;
+    for (int k = 0; k < VOLUME_INDICATORS; ++k) {
+        if (native::prepareOutput(close, lookback[k], r[k]) > 0) out[k] = &r[k][r[k].getFirst()];
+    }
+    if (out[VOLUME_AD] == 0) return r;
+    native::volume(&candles.getHigh()[first], &candles.getLow()[first], &close[first], &close[first],
+                   &candles.getVolume()[first], n, fast, slow, out, lookback);
+    return r;
+}
+
+/// AD, ADOSC and OBV of live bars.
+/**
+ * This state takes one bar at a time in constant time and memory, and
+ * after the same bars its values are those of volume() at the last bar,
+ * without unstable period.
+ */
+class VolumeState
+{
+    TA_Integer fast, slow, count;
+    double fastK, slowK;
+    double previousClose, ad, fastEMA, slowEMA, obv;
+public:
+    VolumeState (TA_Integer _fast = 3, TA_Integer _slow = 10)
+        : fast(_fast), slow(_slow), count(0), fastK(2.0 / (_fast + 1)), slowK(2.0 / (_slow + 1)),
+          previousClose(0), ad(0), fastEMA(0), slowEMA(0), obv(0) {
+    }
+
+    /// Add the next bar.
+    void push (double high, double low, double close, double volume) {
+        ad += native::moneyFlow(high, low, close, volume);
+        if (count == 0) {
+            fastEMA = slowEMA = ad;
+            obv = volume;
+        }
+        else {
+            fastEMA = (fastK * ad) + ((1.0 - fastK) * fastEMA);
+            slowEMA = (slowK * ad) + ((1.0 - slowK) * slowEMA);
+            obv += native::signedVolume(close, previousClose, volume);
+        }
+        previousClose = close;
+        ++count;
+    }
+
+    /// Add the next candle.
+    void push (const Candle &candle) {
+        push(candle.high, candle.low, candle.close, candle.volume);
+    }
+
+    /// Number of bars added.
+    TA_Integer size () const {
+        return count;
+    }
+
+    /// Check whether ADOSC is available, from bar max(fast, slow) - 1 on.
+    bool ready () const {
+        return count >= std::max(fast, slow);
+    }
+
+    double getAD () const {
+        return ad;
+    }
+
+    double getADOSC () const {
+        return fastEMA - slowEMA;
+    }
+
+    double getOBV () const {
+        return obv;
+    }
+};
+
+}
+
+#endif
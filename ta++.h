@@ -39,8 +39,9 @@
  *  on Gnuplot.
  *
  *  \section install_sec Installation 
- *  There are only two files in the library: ta++.h and ta++-plot.h.  Just drop
- *  these files in somewhere your C++ compiler is aware of and you are done.
+ *  The library is header only: ta++.h, ta++-plot.h and the ta++-*.h files
+ *  included by ta++.h.  Just drop these files in somewhere your C++ compiler
+ *  is aware of and you are done.
  *
  *  \section link_sec Compile and Link
  *  TA++ depends on two libraries: TA-lib and boost date & time.  If you use g++
@@ -214,19 +215,43 @@ public:
     }
 };
 
+template <typename E> class Expr;
+
 /// The template for series type.
 /**
  * A series of atomic type like TA_Integer and TA_Real is just a STL vector
  * combined with the properties of BaseSeries.
+ *
+ * A series can also be constructed from or assigned an arithmetic
+ * expression of other series, see ta++-expr.h.
  */
 template <typename T>
 class Series: public BaseSeries, public std::vector<T>
 {
+public:
+    Series () {
+    }
+
+    /// Evaluate an expression into a new series.
+    template <typename E>
+    Series (const Expr<E> &e) {
+        e.assignTo(*this);
+    }
+
+    /// Evaluate an expression into this series.
+    template <typename E>
+    Series &operator = (const Expr<E> &e) {
+        e.assignTo(*this);
+        return *this;
+    }
 };
 
 /// Real series.
 typedef Series<TA_Real> RealSeries;
 
+/// Single precision real series, see ta++-float.h.
+typedef Series<float> FloatSeries;
+
 /// Integer Series.
 typedef Series<TA_Integer> IntegerSeries;
 
@@ -253,6 +278,10 @@ class Candles: public BaseSeries
     RealSeries openInterest;
     TimeSeries time;
 public:
+    /// Initialize an empty series.
+    Candles () {
+    }
+
     /**
      * Initialize from a file.  This is the same as invoking
      * LoadFromFile with the same parameters immediately after
@@ -286,16 +315,21 @@ public:
             candle.time = str2time(buf);
             if (candle.time < begin) continue;
             if (candle.time >= end) break;
-            time.push_back(candle.time);
-            open.push_back(candle.open);
-            high.push_back(candle.high);
-            low.push_back(candle.low);
-            close.push_back(candle.close);
-            volume.push_back(candle.volume);
-            openInterest.push_back(candle.openInterest);
+            push_back(candle);
         }
     }
 
+    /// Append a candle.
+    void push_back (const Candle &candle) {
+        time.push_back(candle.time);
+        open.push_back(candle.open);
+        high.push_back(candle.high);
+        low.push_back(candle.low);
+        close.push_back(candle.close);
+        volume.push_back(candle.volume);
+        openInterest.push_back(candle.openInterest);
+    }
+
     /// Access a candle in the series as a whole.
     Candle operator [] (unsigned i) {
         return Candle(open[i], high[i], low[i], close[i], volume[i], openInterest[i], time[i]);
@@ -358,9 +392,104 @@ public:
 };
 
 
-/// The TA indicator class.
-class TA
+/// Arguments of a native implementation of a TA function.
+/**
+ * Some TA functions have native implementations in TA++, which TA uses
+ * instead of TA-lib, see ta++-native.h.  The calling convention mirrors
+ * TA_CallFunc: every input has size elements, and every output receives
+ * size - lookback elements, the first of which corresponds to input element
+ * lookback.  The lookback is the one reported by TA-lib, so it includes the
+ * unstable period.
+ */
+template <typename T>
+struct NativeCall {
+    /// Number of input elements.
+    TA_Integer size;
+    /// Input element of the first output element.
+    TA_Integer lookback;
+    /// Real inputs, in the order of the function's inputs.
+    const T *real[2];
+    /// Columns of the price input, if the function has one.
+    const T *open, *high, *low, *close, *volume;
+    /// Optional inputs in the order of the function's optional inputs.
+    const TA_Real *options;
+    /// Real outputs.
+    T *out[3];
+    /// Integer outputs.
+    TA_Integer *outInteger[3];
+
+    /// Get an integer optional input.
+    TA_Integer integer (unsigned i) const {
+        return TA_Integer(options[i]);
+    }
+};
+
+/// A TA function implemented natively in precision T.
+/**
+ * The implementation returns false if it does not support the options or
+ * the global TA-lib settings of the call, in which case TA-lib is used.
+ */
+template <typename T>
+struct NativeFunction {
+    const char *name;
+    bool (*call)(const NativeCall<T> &call);
+};
+
+/// Look up the native implementation of a TA function, see ta++-native.h.
+template <typename T>
+static inline const NativeFunction<T> *findNative (const std::string &name);
+
+namespace detail {
+
+// Not static: the switch is shared by all translation units.
+inline bool &nativeEnabled () {
+    static bool enabled = true;
+    return enabled;
+}
+
+}
+
+/// Enable or disable native implementations.
+/**
+ * Native implementations are enabled by default.  Disabling them makes TA
+ * call TA-lib for everything, e.g. to compare results.  Returns the previous
+ * setting.
+ */
+static inline bool setNativeEnabled (bool enabled) {
+    bool old = detail::nativeEnabled();
+    detail::nativeEnabled() = enabled;
+    return old;
+}
+
+/// Check whether native implementations are enabled.
+static inline bool isNativeEnabled () {
+    return detail::nativeEnabled();
+}
+
+namespace detail {
+
+// Not static: the switch is shared by all translation units.
+inline bool &costLearning () {
+    static bool enabled = false;
+    return enabled;
+}
+
+static inline double costClock ();
+
+}
+
+/// Record the time a TA function took in the cost model, see ta++-cost.h.
+static inline void learnCost (const std::string &function, size_t size, double seconds);
+
+/// Options of TA indicators.
+/**
+ * This is the part of TA indicators which does not depend on the value type
+ * of the output series.  Options built with TA::getDefault() can be passed
+ * to any BasicTA.
+ */
+class TABase
 {
+protected:
     enum OptionType {
         REAL, INTEGER
     };
@@ -391,24 +520,6 @@ class TA
     };
 
 public:
-    /// Output series.
-    /**
-     * Though the struct contains two series real and integer, only one
-     * is valid depeding on the type field.
-     */
-    struct Output {
-        /// Type of the series.
-        /** can be TA_Output_Real or TA_Output_Integer.
-         */
-        TA_OutputParameterType type;
-        /// Name of the series.
-        std::string name;
-        /// Real series.
-        RealSeries real;
-        /// Integer series.
-        IntegerSeries integer;
-    };
-
     /// Options to a TA indicator.
     class Options: public std::vector<Option> {
     public:
@@ -430,6 +541,42 @@ public:
     static Options getDefault() {
         return Options();
     }
+};
+
+/// The TA indicator class.
+/**
+ * T is the value type of the real output series.  Use TA for double and
+ * FloatTA for float outputs.
+ *
+ * Real inputs may be series of any value type.  TA-lib only computes in
+ * double, so series of other types are converted before calling TA-lib and
+ * the outputs are converted back.
+ *
+ * Functions with a native implementation in TA++ do not go through TA-lib
+ * at all unless the implementation declines the options, see
+ * ta++-native.h.
+ */
+template <typename T>
+class BasicTA: public TABase
+{
+public:
+    /// Output series.
+    /**
+     * Though the struct contains two series real and integer, only one
+     * is valid depeding on the type field.
+     */
+    struct Output {
+        /// Type of the series.
+        /** can be TA_Output_Real or TA_Output_Integer.
+         */
+        TA_OutputParameterType type;
+        /// Name of the series.
+        std::string name;
+        /// Real series.
+        Series<T> real;
+        /// Integer series.
+        IntegerSeries integer;
+    };
 
     /// List of output series.
     typedef std::vector<Output> Outputs;
@@ -439,23 +586,47 @@ private:
 	const TA_FuncHandle *funcHandle;
 	const TA_FuncInfo *funcInfo;
 	TA_ParamHolder *params;
+    const NativeFunction<T> *native;
 
     OptionMap optionMap;
+    std::vector<TA_Real> optionValues;
     Outputs outputs;
 
     unsigned inputFirst;
     unsigned inputSize;
 
+    // Inputs are bound to TA-lib or to the native call only when it is
+    // known which one computes the function.
+    typedef bool (BasicTA::*Binder)(unsigned idx, const void *input, bool toNative);
+    struct Input {
+        const void *input;
+        Binder bind;
+        // The price columns a price input reads, TA_IN_PRICE_* flags.
+        TA_InputFlags flags;
+    };
+    std::vector<Input> inputs;
+    NativeCall<T> call;
+
+    // Conversion buffers of inputs and outputs not in double.
+    std::vector<std::vector<TA_Real> > inputBuffers;
+    std::vector<std::vector<TA_Real> > outputBuffers;
+    // Conversion buffers of native inputs not in T: two real inputs
+    // followed by the open, high, low, close and volume columns.
+    std::vector<std::vector<T> > nativeBuffers;
+
     void Init (const std::string &name) {
 		if (TA_GetFuncHandle(name.c_str(), &funcHandle) != TA_SUCCESS) panic();
 		if (TA_GetFuncInfo(funcHandle, &funcInfo) != TA_SUCCESS) panic();
 		if (TA_ParamHolderAlloc(funcHandle, &params) != TA_SUCCESS) panic();
 
+        native = findNative<T>(funcInfo->name);
+
         // opt input parameter info
         for (unsigned i = 0; i < funcInfo->nbOptInput; ++i) {
             const TA_OptInputParameterInfo *info;
 		    if (TA_GetOptInputParameterInfo(funcHandle, i, &info) != TA_SUCCESS) panic();
             optionMap[std::string(info->paramName)] = i;
+            optionValues.push_back(info->defaultValue);
         }
 
         outputs.resize(funcInfo->nbOutput);
@@ -467,51 +638,141 @@ private:
             outputs[i].real.setFlags(info->flags);
             outputs[i].integer.setFlags(info->flags);
         }
+
+        inputs.resize(funcInfo->nbInput);
+        inputBuffers.resize(funcInfo->nbInput);
+        outputBuffers.resize(funcInfo->nbOutput);
+        nativeBuffers.resize(7);
+    }
+
+    const TA_Real *realInput (unsigned, const RealSeries &input) {
+        return &input[inputFirst];
+    }
+
+    template <typename U>
+    const TA_Real *realInput (unsigned idx, const Series<U> &input) {
+        std::vector<TA_Real> &buffer = inputBuffers[idx];
+        buffer.assign(input.begin() + inputFirst, input.begin() + inputSize);
+        return &buffer[0];
+    }
+
+    TA_Real *realOutput (unsigned, RealSeries &output, TA_Integer outputFirst) {
+        return &output[outputFirst];
+    }
+
+    template <typename U>
+    TA_Real *realOutput (unsigned idx, Series<U> &output, TA_Integer outputFirst) {
+        std::vector<TA_Real> &buffer = outputBuffers[idx];
+        buffer.resize(output.size() - outputFirst);
+        return &buffer[0];
+    }
+
+    void copyOutput (unsigned, RealSeries &, TA_Integer) {
+    }
+
+    template <typename U>
+    void copyOutput (unsigned idx, Series<U> &output, TA_Integer outputFirst) {
+        std::copy(outputBuffers[idx].begin(), outputBuffers[idx].end(), output.begin() + outputFirst);
+    }
+
+    const T *nativeInput (unsigned, const Series<T> &input) {
+        return &input[inputFirst];
+    }
+
+    template <typename U>
+    const T *nativeInput (unsigned slot, const Series<U> &input) {
+        std::vector<T> &buffer = nativeBuffers[slot];
+        buffer.assign(input.begin() + inputFirst, input.begin() + inputSize);
+        return &buffer[0];
+    }
+
+    template <typename U>
+    bool bindReal (unsigned idx, const void *p, bool toNative) {
+        const Series<U> &input = *static_cast<const Series<U> *>(p);
+        if (toNative) {
+            call.real[idx] = nativeInput(idx, input);
+        }
+        else if (TA_SetInputParamRealPtr(params, idx, realInput(idx, input)) != TA_SUCCESS) panic();
+        return true;
+    }
+
+    bool bindInteger (unsigned idx, const void *p, bool toNative) {
+        const IntegerSeries &input = *static_cast<const IntegerSeries *>(p);
+        if (toNative) return false;
+        if (TA_SetInputParamIntegerPtr(params, idx, &input[inputFirst]) != TA_SUCCESS) panic();
+        return true;
+    }
+
+    bool bindPrice (unsigned idx, const void *p, bool toNative) {
+        const Candles &input = *static_cast<const Candles *>(p);
+        if (toNative) {
+            // Candles are stored in double, so in float only the columns
+            // the function reads are converted.
+            TA_InputFlags flags = inputs[idx].flags;
+            call.open = flags & TA_IN_PRICE_OPEN ? nativeInput(2, input.getOpen()) : 0;
+            call.high = flags & TA_IN_PRICE_HIGH ? nativeInput(3, input.getHigh()) : 0;
+            call.low = flags & TA_IN_PRICE_LOW ? nativeInput(4, input.getLow()) : 0;
+            call.close = flags & TA_IN_PRICE_CLOSE ? nativeInput(5, input.getClose()) : 0;
+            call.volume = flags & TA_IN_PRICE_VOLUME ? nativeInput(6, input.getVolume()) : 0;
+        }
+        else if (TA_SetInputParamPricePtr(params, idx,
+                    &input.getOpen()[inputFirst],
+                    &input.getHigh()[inputFirst],
+                    &input.getLow()[inputFirst],
+                    &input.getClose()[inputFirst],
+                    &input.getVolume()[inputFirst],
+                    &input.getOpenInterest()[inputFirst]) != TA_SUCCESS) panic();
+        return true;
+    }
+
+    bool bindInputs (bool toNative) {
+        for (unsigned i = 0; i < inputs.size(); ++i) {
+            if (!(this->*inputs[i].bind)(i, inputs[i].input, toNative)) return false;
+        }
+        return true;
     }
 
-    void setInputHelper (unsigned idx, const RealSeries &input) {
+    template <typename U>
+    void setInputHelper (unsigned idx, const Series<U> &input) {
         const TA_InputParameterInfo *info;
 		if (TA_GetInputParameterInfo(funcHandle, idx, &info) != TA_SUCCESS) panic();
         verify(info->type == TA_Input_Real);
-        if (TA_SetInputParamRealPtr(params, idx, &input[inputFirst]) != TA_SUCCESS) panic();
+        inputs[idx].input = &input;
+        inputs[idx].bind = &BasicTA::template bindReal<U>;
     };
 
     void setInputHelper (unsigned idx, const IntegerSeries &input) {
         const TA_InputParameterInfo *info;
 		if (TA_GetInputParameterInfo(funcHandle, idx, &info) != TA_SUCCESS) panic();
         verify(info->type == TA_Input_Integer);
-        if (TA_SetInputParamIntegerPtr(params, idx, &input[inputFirst]) != TA_SUCCESS) panic();
+        inputs[idx].input = &input;
+        inputs[idx].bind = &BasicTA::bindInteger;
     };
 
     void setInputHelper (unsigned idx, const Candles &input) {
         const TA_InputParameterInfo *info;
 		if (TA_GetInputParameterInfo(funcHandle, idx, &info) != TA_SUCCESS) panic();
         verify(info->type == TA_Input_Price);
-        if (TA_SetInputParamPricePtr(params, idx,
-                    &input.getOpen()[inputFirst],
-                    &input.getHigh()[inputFirst],
-                    &input.getLow()[inputFirst],
-                    &input.getClose()[inputFirst],
-                    &input.getVolume()[inputFirst],
-                    &input.getOpenInterest()[inputFirst]) != TA_SUCCESS) panic();
+        inputs[idx].input = &input;
+        inputs[idx].bind = &BasicTA::bindPrice;
+        inputs[idx].flags = info->flags;
     };
 
-    template <typename T>
-    void setInput (const T &input) {
+    template <typename I>
+    void setInput (const I &input) {
         verify(funcInfo->nbInput == 1);
         inputFirst = input.getFirst();
         inputSize = input.size();
         setInputHelper(0, input);
     };
 
-    template <typename T1, typename T2>
-    void setInput (const T1 &input1, const T2 &input2) {
+    template <typename I1, typename I2>
+    void setInput (const I1 &input1, const I2 &input2) {
         verify(funcInfo->nbInput == 2);
         inputFirst = std::max(input1.getFirst(), input2.getFirst());
         inputSize = std::min(input1.size(), input2.size());
         setInputHelper(0, input1);
         setInputHelper(1, input2);
-        return *this;
     };
 
 
@@ -524,14 +785,32 @@ private:
         if (info->type == TA_OptInput_RealRange
             || info->type == TA_OptInput_RealList) {
             if (TA_SetOptInputParamReal(params, it->second, option.getReal()) != TA_SUCCESS) panic();
+            optionValues[it->second] = option.getReal();
         }
         else if (info->type == TA_OptInput_IntegerRange
             || info->type == TA_OptInput_IntegerList) {
             if (TA_SetOptInputParamInteger(params, it->second, option.getInteger()) != TA_SUCCESS) panic();
+            optionValues[it->second] = option.getInteger();
         }
     };
 
-    void update ()
+    bool updateNative (TA_Integer lookback, TA_Integer outputFirst)
+    {
+        if (native == 0 || !isNativeEnabled()) return false;
+        if (TA_Integer(inputSize) <= outputFirst) return false;
+        if (!bindInputs(true)) return false;
+        call.size = inputSize - inputFirst;
+        call.lookback = lookback;
+        call.options = optionValues.empty() ? 0 : &optionValues[0];
+        for (unsigned i = 0; i < outputs.size() && i < 3; ++i) {
+            bool real = outputs[i].type == TA_Output_Real;
+            call.out[i] = real ? &outputs[i].real[outputFirst] : 0;
+            call.outInteger[i] = real ? 0 : &outputs[i].integer[outputFirst];
+        }
+        return native->call(call);
+    }
+
+    void compute ()
     {
         TA_Integer lookback = 0;
         if (TA_GetLookback(params, &lookback) != TA_SUCCESS) panic();
@@ -541,29 +820,53 @@ private:
             case TA_Output_Real:
                 outputs[i].real.setFirst(outputFirst);
                 outputs[i].real.resize(inputSize);
-                if (TA_SetOutputParamRealPtr(params, i, &outputs[i].real[outputFirst]) != TA_SUCCESS) panic();
                 break;
             case TA_Output_Integer:
                 outputs[i].integer.setFirst(outputFirst);
                 outputs[i].integer.resize(inputSize);
-                if (TA_SetOutputParamIntegerPtr(params, i, &outputs[i].integer[outputFirst]) != TA_SUCCESS) panic();
                 break;
                 default:
                 panic();
             }
         }
+        if (updateNative(lookback, outputFirst)) return;
+        bindInputs(false);
+        for (unsigned i = 0; i < outputs.size(); ++i) {
+            if (outputs[i].type == TA_Output_Real) {
+                if (TA_SetOutputParamRealPtr(params, i, realOutput(i, outputs[i].real, outputFirst)) != TA_SUCCESS) panic();
+            }
+            else {
+                if (TA_SetOutputParamIntegerPtr(params, i, &outputs[i].integer[outputFirst]) != TA_SUCCESS) panic();
+            }
+        }
         TA_Integer outBegIdx, outNbElement;
         if (TA_CallFunc(params, 0, inputSize - inputFirst - 1, &outBegIdx, &outNbElement) != TA_SUCCESS) panic();
         verify(outBegIdx == lookback);
         verify(outNbElement == inputSize - outputFirst);
+        for (unsigned i = 0; i < outputs.size(); ++i) {
+            if (outputs[i].type == TA_Output_Real) {
+                copyOutput(i, outputs[i].real, outputFirst);
+            }
+        }
+    }
+
+    void update ()
+    {
+        if (!detail::costLearning()) {
+            compute();
+            return;
+        }
+        double start = detail::costClock();
+        compute();
+        learnCost(funcInfo->name, inputSize - inputFirst, detail::costClock() - start);
     }
 
 public:
     /**
      * Initialize a TA indicator with one input series.
      */
-    template <typename T>
-	TA (const std::string &name, const T& input, const Options &options = Options())
+    template <typename I>
+	BasicTA (const std::string &name, const I& input, const Options &options = Options())
 	{
         Init(name);
         BOOST_FOREACH(const Option &option, options) {
@@ -576,8 +879,8 @@ public:
     /**
      * Initialize a TA indicator with two input series.
      */
-    template <typename T1, typename T2>
-	TA (const std::string &name, const T1& input1, const T2 &input2, const Options &options = Options())
+    template <typename I1, typename I2>
+	BasicTA (const std::string &name, const I1& input1, const I2 &input2, const Options &options = Options())
 	{
         Init(name);
         BOOST_FOREACH(const Option &option, options) {
@@ -608,7 +911,19 @@ public:
     }
 };
 
+/// TA indicator with double outputs.
+typedef BasicTA<TA_Real> TA;
+
+/// TA indicator with float outputs, see ta++-float.h.
+typedef BasicTA<float> FloatTA;
+
 }
 
+#include "ta++-cpu.h"
+#include "ta++-expr.h"
+#include "ta++-float.h"
+#include "ta++-native.h"
+#include "ta++-cost.h"
+
 #endif
 